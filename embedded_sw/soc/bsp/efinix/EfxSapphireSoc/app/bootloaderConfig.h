@@ -27,33 +27,149 @@
 #include "io.h"
 #include "spiFlash.h"
 #include "start.h"
+#include "clint.h"
+#include "dmasg.h"
+#include "vexriscv.h"
+#include "bootImage.h"
 
 #define SPI SYSTEM_SPI_0_IO_CTRL
 #define SPI_CS 0
 
 #define USER_SOFTWARE_MEMORY 0xF9000000
 #define USER_SOFTWARE_FLASH  0x00380000
-#define USER_SOFTWARE_SIZE   0x3fc00
+#define USER_SOFTWARE_SIZE   0x3f000 // Most bytes loaded, the bootloader itself is located right after (bootloader.ld)
 
 #define SINGLE_SPI 1 //define DUAL_SPI for dual data SPI or QUAD_SPI for quad data SPI
 
+// DMA channel streaming the SPI RX bytes to memory.
+// Set SPI_DMASG_PORT to the dmasg input port wired to the SPI RX stream when the SoC is generated with the DMA,
+// the image is then loaded by the DMA. Otherwise, or if the DMA doesn't complete, the CPU loads it.
+#if defined(SYSTEM_DMASG_CTRL) && defined(SPI_DMASG_PORT)
+    #define SPI_DMASG_CTRL SYSTEM_DMASG_CTRL
+    #define SPI_DMASG_CHANNEL 0
+#else
+    #define SPI_DMASG_CTRL 0
+    #define SPI_DMASG_CHANNEL 0
+    #undef  SPI_DMASG_PORT
+    #define SPI_DMASG_PORT 0
+#endif
+// Time the DMA has to write the last bytes once the SPI is done
+#define SPI_DMASG_TIMEOUT_US 10000
+
+#ifdef SINGLE_SPI
+    #define SPI_FLASH_MODE 0
+#elif DUAL_SPI
+    #define SPI_FLASH_MODE 1 // dual data line half duplex
+#elif QUAD_SPI
+    #define SPI_FLASH_MODE 2 // quad data line half duplex
+#else
+    #error "You must either define SINGLE_SPI to use single data line SPI, DUAL_SPI to use dual data line SPI or QUAD_SPI to use quad data line SPI."
+#endif
+
+// Copy flash to memory with the DMA, returns 0 if the transfer didn't complete
+static u32 bspCopyDma(u32 flashAddress, u32 memoryAddress, u32 size) {
+	spiFlash_f2m_dma(SPI, SPI_CS, SPI_DMASG_CTRL, SPI_DMASG_CHANNEL, SPI_DMASG_PORT, SPI_FLASH_MODE, flashAddress, memoryAddress, size);
+	u64 deadline = clint_getTime(BSP_CLINT) + (u64)SPI_DMASG_TIMEOUT_US*(BSP_CLINT_HZ/1000000);
+	while(dmasg_busy(SPI_DMASG_CTRL, SPI_DMASG_CHANNEL)){
+		if(clint_getTime(BSP_CLINT) > deadline){
+			dmasg_stop(SPI_DMASG_CTRL, SPI_DMASG_CHANNEL);
+			while(dmasg_busy(SPI_DMASG_CTRL, SPI_DMASG_CHANNEL));
+			return 0;
+		}
+	}
+	data_cache_invalidate_all(); // The DMA wrote the memory behind the data cache
+	return 1;
+}
+
+// Copy flash to memory as it is, returns crc updated with the data (see crc32.h)
+static u32 bspCopy(u32 flashAddress, u32 memoryAddress, u32 size, u32 crc) {
+	if(SPI_DMASG_CTRL && bspCopyDma(flashAddress, memoryAddress, size)){
+		return crc32_update(crc, (void *)memoryAddress, size); // The CPU didn't see the data, once more over the memory
+	}
+	return spiFlash_f2m_crc(SPI, SPI_CS, SPI_FLASH_MODE, flashAddress, memoryAddress, size, crc);
+}
+
+// Load the user software, returns its entry point or 0 if the image is corrupted.
+// A boot image (see bootImage.h) loads only its segments, decompressing them while they are read if
+// it is compressed, and zeroes their .bss. Its CRC32 is computed along the flash read, an image which
+// doesn't match isn't started. Anything else is a plain binary, USER_SOFTWARE_SIZE bytes are copied.
+static u32 bspLoad() {
+	static BootImage_Header header; // Not on the stack, it is only 256 bytes (bootloader.ld)
+	static SpiFlash_Stream stream;
+	u32 flash = USER_SOFTWARE_FLASH + sizeof(BootImage_Header);
+	u32 lz4, crc;
+	bspCopy(USER_SOFTWARE_FLASH, (u32)&header, sizeof(BootImage_Header), CRC32_INIT);
+	if(header.magic != BOOT_IMAGE_MAGIC){
+		if(bootImage_damaged(&header)){
+			bsp_putString("Boot image header damaged\n");
+			return 0;
+		}
+		bspCopy(USER_SOFTWARE_FLASH, USER_SOFTWARE_MEMORY, USER_SOFTWARE_SIZE, CRC32_INIT);
+		return USER_SOFTWARE_MEMORY;
+	}
+	if(!bootImage_valid(&header, USER_SOFTWARE_MEMORY, USER_SOFTWARE_SIZE)){
+		bsp_putString("Boot image header invalid\n");
+		return 0;
+	}
+	crc = bootImage_headerCrc(&header);
+	lz4 = header.flags & BOOT_IMAGE_LZ4;
+	if(lz4){
+		spiFlash_stream_start(&stream, SPI, SPI_CS, SPI_FLASH_MODE, flash, header.compressedLength);
+		stream.crc = crc;
+	}
+	for(u32 i = 0;i < header.segmentCount;i++){
+		BootImage_Segment *segment = &header.segments[i];
+		if(!lz4){
+			crc = bspCopy(flash, segment->address, segment->length, crc);
+		} else if(!bootImage_lz4Stream(&stream, segment->address, segment->length, segment->storedLength)){
+			spiFlash_stream_stop(&stream);
+			bsp_putString("Boot image corrupted\n");
+			return 0;
+		}
+		flash += segment->storedLength;
+		bootImage_zero(segment);
+	}
+	if(lz4){
+		crc = stream.crc;
+		spiFlash_stream_stop(&stream);
+	}
+	if(crc32_final(crc) != header.crc){
+		bsp_putString("Boot image CRC error\n");
+		return 0;
+	}
+	return header.entry;
+}
+
+#ifdef BOOTLOADER_REPORT
+// bsp_printf needs more stack than the 256 bytes of the bootloader (bootloader.ld), and bsp_utoa()
+// its 200 bytes table
+static void bspPrintDec(u32 value) {
+	char buffer[11];
+	char *p = buffer + 10;
+	*p = 0;
+	do {
+		*(--p) = '0' + value % 10;
+		value /= 10;
+	} while(value);
+	bsp_putString(p);
+}
+#endif
+
 void bspMain() {
+	void (*userMain)() = (void (*)())USER_SOFTWARE_MEMORY;
 #ifndef SIM
 	spiFlash_init(SPI, SPI_CS);
 	spiFlash_wake(SPI, SPI_CS);
-#ifdef SINGLE_SPI
-	spiFlash_f2m(SPI, SPI_CS, USER_SOFTWARE_FLASH, USER_SOFTWARE_MEMORY, USER_SOFTWARE_SIZE);
-#elif DUAL_SPI 
-    spiFlash_f2m_dual(SPI, SPI_CS, USER_SOFTWARE_FLASH, USER_SOFTWARE_MEMORY, USER_SOFTWARE_SIZE); // dual data line half duplex
-#elif QUAD_SPI
-    spiFlash_f2m_quad(SPI, SPI_CS, USER_SOFTWARE_FLASH, USER_SOFTWARE_MEMORY, USER_SOFTWARE_SIZE); // quad data line full duplex
-#else 
-    	#error "You must either define SINGLE_SPI to use single data line SPI, DUAL_SPI to use dual data line SPI or QUAD_SPI to use quad data line SPI."
+	userMain = (void (*)())bspLoad();
+	if(!userMain) while(1); // Refuse to start a corrupted image, bspLoad() reported why
+#ifdef BOOTLOADER_REPORT
+	bsp_putString("Boot at ");
+	bspPrintDec(clint_getTimeLow(BSP_CLINT)/(BSP_CLINT_HZ/1000000)); // No 64 bits division, the boot is over long before it wraps
+	bsp_putString(" us\n");
 #endif
 #endif
 
 	asm("fence.i; nop; nop; nop; nop; nop; nop"); 
-	void (*userMain)() = (void (*)())USER_SOFTWARE_MEMORY;
     #ifdef SMP
         smp_unlock(userMain);
     #endif
@@ -0,0 +1,190 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include <string.h>
+#include "type.h"
+#include "riscv.h"
+#include "clint.h"
+#include "bsp.h"
+
+// Multi-hart lock-free console.
+// Each hart logs into its own single producer / single consumer ring, so logging from
+// a hot loop only costs a copy into RAM. One designated hart calls hartLog_drain()
+// to send the lines out of the UART in the order they were logged, tagged with the
+// hart ID and the CLINT timestamp. The global order comes from a sequence number
+// taken with amoadd.w, the same pattern as atomicAdd() in smpDemo. A line is sent
+// once it is published, so a slower hart can still appear after a newer line.
+
+#ifndef HARTLOG_HART_COUNT
+#ifdef HART_COUNT
+#define HARTLOG_HART_COUNT HART_COUNT
+#else
+#define HARTLOG_HART_COUNT 4
+#endif
+#endif
+
+// Number of lines per hart, must be a power of two
+#ifndef HARTLOG_SLOTS
+#define HARTLOG_SLOTS 32
+#endif
+
+#define HARTLOG_TEXT_SIZE   48
+#define HARTLOG_HAS_VALUE   BIT_0
+
+    typedef struct {
+        u32 sequence;
+        u32 flags;
+        u64 timestamp;
+        u32 value;
+        u32 length;
+        char text[HARTLOG_TEXT_SIZE];
+    } HartLog_Line;
+
+    typedef struct {
+        // head is only written by the owner hart, tail only by the drainer
+        volatile u32 head;
+        volatile u32 tail;
+        volatile u32 dropped;
+        HartLog_Line lines[HARTLOG_SLOTS];
+    } HartLog_Ring;
+
+    static volatile u32 hartLog_sequence = 0;
+    static volatile u32 hartLog_droppedOther = 0; // Lines of harts beyond HARTLOG_HART_COUNT, they have no ring
+    static HartLog_Ring hartLog_rings[HARTLOG_HART_COUNT];
+
+    static inline __attribute__((always_inline)) u32 hartLog_fetchAdd(volatile u32 *a, u32 increment){
+        u32 old;
+        __asm__ volatile(
+              "amoadd.w %[old], %[increment], (%[atomic])"
+            : [old] "=r"(old)
+            : [increment] "r"(increment), [atomic] "r"(a)
+            : "memory"
+        );
+        return old;
+    }
+
+    static void hartLog_push(const char *str, u32 len, u32 value, u32 flags){
+        u32 hartId = csr_read(mhartid);
+        if(hartId >= HARTLOG_HART_COUNT){
+            hartLog_fetchAdd(&hartLog_droppedOther, 1);
+            return;
+        }
+        HartLog_Ring *ring = &hartLog_rings[hartId];
+        u32 head = ring->head;
+        if(head - ring->tail == HARTLOG_SLOTS){
+            ring->dropped++;
+            return;
+        }
+        HartLog_Line *line = &ring->lines[head & (HARTLOG_SLOTS-1)];
+        if(len > HARTLOG_TEXT_SIZE) len = HARTLOG_TEXT_SIZE;
+        line->sequence = hartLog_fetchAdd(&hartLog_sequence, 1);
+        line->timestamp = clint_getTime(BSP_CLINT);
+        line->value = value;
+        line->flags = flags;
+        line->length = len;
+        memcpy(line->text, str, len);
+        asm("fence w,w");
+        ring->head = head + 1;
+    }
+
+    /**
+    * Log a string from the calling hart, never waits on the UART.
+    * The line is dropped if the hart ring is full, or if the hart ID is not below HARTLOG_HART_COUNT.
+    */
+    static void hartLog_str(const char *str){
+        hartLog_push(str, strlen(str), 0, 0);
+    }
+
+    /**
+    * Log a string followed by a value, the value is only formatted in hexadecimal when the line is drained.
+    */
+    static void hartLog_strHex(const char *str, u32 value){
+        hartLog_push(str, strlen(str), value, HARTLOG_HAS_VALUE);
+    }
+
+    /**
+    * Send the logged lines to the UART in sequence order, to be called by a single hart.
+    *
+    * @return number of lines sent
+    */
+    static u32 hartLog_drain(){
+        u32 count = 0;
+        while(1){
+            HartLog_Ring *next = 0;
+            HartLog_Line *nextLine = 0;
+            for(u32 hart = 0;hart < HARTLOG_HART_COUNT;hart++){
+                HartLog_Ring *ring = &hartLog_rings[hart];
+                if(ring->tail == ring->head) continue;
+                asm("fence r,r");
+                HartLog_Line *line = &ring->lines[ring->tail & (HARTLOG_SLOTS-1)];
+                if(!nextLine || (s32)(line->sequence - nextLine->sequence) < 0){
+                    next = ring;
+                    nextLine = line;
+                }
+            }
+            if(!next) return count;
+
+            char header[32];
+            char *p = header;
+            *p++ = '[';
+            *p++ = 'h';
+            *p++ = '0' + (next - hartLog_rings);
+            *p++ = ' ';
+            u32 timestamp = nextLine->timestamp;
+            for(s32 i = 28;i >= 0;i -= 4) *p++ = "0123456789abcdef"[(timestamp >> i) & 0xF];
+            *p++ = ']';
+            *p++ = ' ';
+            _putchar_buf(header, p - header);
+            _putchar_buf(nextLine->text, nextLine->length);
+            if(nextLine->flags & HARTLOG_HAS_VALUE) bsp_printHex_lower(nextLine->value);
+            _putchar_buf("\r\n", 2);
+
+            asm("fence rw,w");
+            next->tail++;
+            count++;
+        }
+    }
+
+    // Number of lines dropped by a hart because its ring was full, or by all the harts
+    // beyond HARTLOG_HART_COUNT for a larger hartId
+    static u32 hartLog_dropped(u32 hartId){
+        if(hartId >= HARTLOG_HART_COUNT) return hartLog_droppedOther;
+        return hartLog_rings[hartId].dropped;
+    }
+
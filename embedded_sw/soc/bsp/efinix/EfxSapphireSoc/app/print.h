@@ -50,112 +50,70 @@
 
 
     #if (ENABLE_FLOATING_POINT_SUPPORT)
-    /* reverse:  reverse string s in place */
-     static void reverse(char s[])
-     {
-          int i, j, len;
-          char c;
-    
-          for (i = 0, j = strlen(s)-1; i<j; i++, j--) {
-              c = s[i];
-              s[i] = s[j];
-              s[j] = c;
-          }
-     }
-    
     /* itos:  convert integer n to characters in s */
      static void itos(int n, char s[])
      {
-         int i, sign;
-    
-         if ((sign = n) < 0)  /* record sign */
-             n = -n;          /* make n positive */
-         i = 0;
-         do {       /* generate digits in reverse order */
-             s[i++] = n % 10 + '0';   /* get next digit */
-         } while ((n /= 10) > 0);     /* delete it */
-         if (sign < 0)
-             s[i++] = '-';
-         s[i] = '\0';
-         reverse(s);
+         char buffer[11];
+         char *end = buffer + sizeof(buffer);
+         char *p = bsp_utoa(n < 0 ? -(uint32_t)n : (uint32_t)n, end);
+
+         if (n < 0)
+             *(s++) = '-';
+         memcpy(s, p, end - p);
+         s[end - p] = '\0';
     }
-    
-    // Converts a floating-point/double number to a string.
-    static void ftoa(double n, char* res1, char* res2)
+
+    // Converts a floating-point/double number to a string with 4 decimals, rounded to nearest.
+    // Fixed point: the fraction is scaled once by 10000, there is no division nor pow().
+    // Writes the characters before end and returns the first one, needs up to 16 characters.
+    static char *ftoa(double n, char *end)
     {
-        float fpart_f;
-        int afterpoint=4;
-    
-        // Extract integer part
-        int ipart = (int)n;
-    
-        // Extract floating part
-        double fpart = n - (double)ipart;
-    
-        // convert integer part to string
-        itos(n, res1);
-    
-        // add dot
-        *res2 = '.';
-        res2++;
-    
-        // convert fraction part to string
-        fpart_f = (float)fpart * pow(10, afterpoint);
-        if (fpart_f<0)
-        {
-            *res2 = '-';
-            res2++;
-            fpart_f = -(fpart_f);
+        const char *pairs = bsp_decimalPairs();
+        char *p = end;
+        int negative = n < 0;
+
+        if (n != n) {
+            p -= 3;
+            memcpy(p, "nan", 3);
+            return p;
         }
-        // handling of 0 after decimal point e.g. 1.003
-        for (int i=afterpoint; i>0; i--)
-        {
-            if ((fpart_f<(1 * pow(10, i-1))) && (fpart_f>0))
-            {
-                *res2='0';
-                res2++;
-            }
+        if (negative)
+            n = -n;
+        if (n > 4294967295.0)
+            n = 4294967295.0;
+
+        uint32_t ipart = (uint32_t)n;
+        uint32_t fpart = (uint32_t)((n - ipart) * 10000.0 + 0.5);
+        if (fpart >= 10000) {
+            fpart -= 10000;
+            ipart++;
         }
-    
-        itos((int)fpart_f, res2);
+
+        *(--p) = pairs[2*(fpart % 100) + 1];
+        *(--p) = pairs[2*(fpart % 100)];
+        *(--p) = pairs[2*(fpart / 100) + 1];
+        *(--p) = pairs[2*(fpart / 100)];
+        *(--p) = '.';
+        p = bsp_utoa(ipart, p);
+        if (negative)
+            *(--p) = '-';
+        return p;
     }
-    
+
     static void print_dec(uint32_t val)
     {
-        char sval[10];
-        itos(val, sval);
-        _putchar_s(sval);
-
+        char buffer[10];
+        char *end = buffer + sizeof(buffer);
+        char *p = bsp_utoa(val, end);
+        _putchar_buf(p, end - p);
     }
+
     static void print_float(double val)
     {
-        int i, j, neg;
-        neg=0;
-        i=2;
-        j=19;
-        char sval[21], fval[10];
-        ftoa(val, sval, fval);
-        if (fval[1] == '-')
-        {
-            neg = 1;
-            while (i<10)
-            {
-                fval[i-1] = fval[i];
-                i++;
-            }
-
-        }
-        strcat(sval, fval);
-        if ((sval[0] != '-') && (neg == 1))
-        {
-            while (j>=0)
-            {
-                sval[j+1] = sval[j];
-                j--;
-            }
-            sval[0] = '-';
-        }
-        _putchar_s(sval);
+        char buffer[16];
+        char *end = buffer + sizeof(buffer);
+        char *p = ftoa(val, end);
+        _putchar_buf(p, end - p);
     }
 
     #endif //#if (ENABLE_FLOATING_POINT_SUPPORT)
@@ -176,95 +134,171 @@
 
     static void bsp_printf_d(int val)
     {
-        char buffer[32];
-        char *p = buffer;
-        if (val < 0) {
-            bsp_printf_c('-');
-            val = -val;
-        }
-        while (val || p == buffer) {
-            *(p++) = '0' + val % 10;
-            val = val / 10;
-        }
-        while (p != buffer)
-            bsp_printf_c(*(--p));
+        char buffer[11];
+        char *end = buffer + sizeof(buffer);
+        char *p = bsp_utoa(val < 0 ? -(uint32_t)val : (uint32_t)val, end);
+        if (val < 0)
+            *(--p) = '-';
+        _putchar_buf(p, end - p);
     }
 
     static void bsp_printf_x(int val)
     {
-        int i,digi=2;
-
-        for(i=0;i<8;i++)
-        {
-            if((val & (0xFFFFFFF0 <<(4*i))) == 0)
-            {
-                digi=i+1;
-                break;
-            }
-        }
         bsp_printHex_lower(val);
     }
 
     static void bsp_printf_X(int val)
-        {
-            int i,digi=2;
-
-            for(i=0;i<8;i++)
-            {
-                if((val & (0xFFFFFFF0 <<(4*i))) == 0)
-                {
-                    digi=i+1;
-                    break;
-                }
+    {
+        bsp_printHex(val);
+    }
+#if (ENABLE_SEMIHOSTING_PRINT == 0)
+
+    // Size of the chunks bsp_printf hands to the output sink
+    #ifndef BSP_PRINTF_CHUNK
+    #define BSP_PRINTF_CHUNK 64
+    #endif
+
+    // Formatted output, either a caller buffer (bsp_vsnprintf) or a chunk that is sent to
+    // the output sink each time it is full (bsp_vprintf)
+    typedef struct {
+        char *buffer;
+        uint32_t size;
+        uint32_t fill;
+        uint32_t total;
+        int sink;
+    } bsp_printfOutput;
+
+    static void bsp_printfPut(bsp_printfOutput *out, const char *p, uint32_t len)
+    {
+        out->total += len;
+        if (!out->sink) {
+            // keep the space of the terminating null, the rest is truncated
+            uint32_t room = out->size ? out->size - 1 - out->fill : 0;
+            if (len > room)
+                len = room;
+            memcpy(out->buffer + out->fill, p, len);
+            out->fill += len;
+            return;
+        }
+        while (len) {
+            if (!out->fill && len >= out->size) {
+                _putchar_buf(p, len);
+                return;
+            }
+            uint32_t n = out->size - out->fill;
+            if (n > len)
+                n = len;
+            memcpy(out->buffer + out->fill, p, n);
+            out->fill += n;
+            p += n;
+            len -= n;
+            if (out->fill == out->size) {
+                _putchar_buf(out->buffer, out->fill);
+                out->fill = 0;
             }
-            bsp_printHex(val);
         }
-#if (ENABLE_SEMIHOSTING_PRINT == 0)
-    static void bsp_printf(const char *format, ...)
+    }
+
+    static void bsp_vformat(bsp_printfOutput *out, const char *format, va_list ap)
     {
+        char number[16];
+        char *end = number + sizeof(number);
+        char *p;
         int i;
-        va_list ap;
-
-        va_start(ap, format);
 
         for (i = 0; format[i]; i++)
             if (format[i] == '%') {
                 while (format[++i]) {
                     if (format[i] == 'c') {
-                        bsp_printf_c(va_arg(ap,int));
+                        number[0] = va_arg(ap,int);
+                        bsp_printfPut(out, number, 1);
                         break;
                     }
                     else if (format[i] == 's') {
-                        bsp_printf_s(va_arg(ap,char*));
+                        p = va_arg(ap,char*);
+                        bsp_printfPut(out, p, strlen(p));
                         break;
                     }
                     else if (format[i] == 'd') {
-                        bsp_printf_d(va_arg(ap,int));
-                        break;
-                    }
-                    else if (format[i] == 'X') {
-                        bsp_printf_X(va_arg(ap,int));
+                        int val = va_arg(ap,int);
+                        p = bsp_utoa(val < 0 ? -(uint32_t)val : (uint32_t)val, end);
+                        if (val < 0)
+                            *(--p) = '-';
+                        bsp_printfPut(out, p, end - p);
                         break;
                     }
-                    else if (format[i] == 'x') {
-                        bsp_printf_x(va_arg(ap,int));
+                    else if (format[i] == 'X' || format[i] == 'x') {
+                        const char *digits = format[i] == 'X' ? "0123456789ABCDEF" : "0123456789abcdef";
+                        uint32_t val = va_arg(ap,int);
+                        for (int j = 0; j < 8; j++)
+                            number[j] = digits[(val >> (28 - 4*j)) % 16];
+                        bsp_printfPut(out, number, 8);
                         break;
                     }
 #if (ENABLE_FLOATING_POINT_SUPPORT)
                     else if (format[i] == 'f') {
-                        print_float(va_arg(ap,double));
+                        p = ftoa(va_arg(ap,double), end);
+                        bsp_printfPut(out, p, end - p);
                         break;
                     }
 #elif (ENABLE_PRINTF_WARNING)
                     else if (format[i] == 'f') {
-                        bsp_printf_s("<Floating point printing not enable. Please Enable it at bsp.h first...>");
+                        p = "<Floating point printing not enable. Please Enable it at bsp.h first...>";
+                        bsp_printfPut(out, p, strlen(p));
                         break;
                     }
 #endif //#if (ENABLE_FLOATING_POINT_SUPPORT)
                 }
-            } else
-                bsp_printf_c(format[i]);
+                if (!format[i])
+                    break;
+            } else {
+                // copy the whole run of literal characters at once
+                int start = i;
+                while (format[i+1] && format[i+1] != '%')
+                    i++;
+                bsp_printfPut(out, format + start, i - start + 1);
+            }
+    }
+
+    /**
+    * bsp_printf into a caller buffer, the output is truncated to size - 1 characters and always null terminated
+    *
+    * @return number of characters the whole output needs, without the terminating null
+    */
+    static int bsp_vsnprintf(char *buffer, uint32_t size, const char *format, va_list ap)
+    {
+        bsp_printfOutput out = {buffer, size, 0, 0, 0};
+        bsp_vformat(&out, format, ap);
+        if (size)
+            buffer[out.fill] = '\0';
+        return out.total;
+    }
+
+    static int bsp_snprintf(char *buffer, uint32_t size, const char *format, ...)
+    {
+        va_list ap;
+        va_start(ap, format);
+        int ret = bsp_vsnprintf(buffer, size, format, ap);
+        va_end(ap);
+        return ret;
+    }
+
+    // Format in BSP_PRINTF_CHUNK characters chunks, each chunk is a single call to the output sink
+    static int bsp_vprintf(const char *format, va_list ap)
+    {
+        char chunk[BSP_PRINTF_CHUNK];
+        bsp_printfOutput out = {chunk, sizeof(chunk), 0, 0, 1};
+        bsp_vformat(&out, format, ap);
+        if (out.fill)
+            _putchar_buf(chunk, out.fill);
+        return out.total;
+    }
 
+    static void bsp_printf(const char *format, ...)
+    {
+        va_list ap;
+        va_start(ap, format);
+        bsp_vprintf(format, ap);
         va_end(ap);
     }
 
@@ -274,11 +308,26 @@
     {
       va_list va;
       va_start(va, format);
+      const int ret = vprintf_(format, va);
+      va_end(va);
+      return ret;
+    }
+
+    static int bsp_vprintf(const char *format, va_list ap)
+    {
+      return vprintf_(format, ap);
+    }
 
-      char buffer[MAX_STRING_BUFFER_SIZE];
-        const int ret = _vsnprintf(_out_buffer, buffer, (size_t)-1, format, va);
-        _putchar_s(buffer);
+    static int bsp_vsnprintf(char *buffer, uint32_t size, const char *format, va_list ap)
+    {
+      return vsnprintf_(buffer, size, format, ap);
+    }
 
+    static int bsp_snprintf(char *buffer, uint32_t size, const char *format, ...)
+    {
+      va_list va;
+      va_start(va, format);
+      const int ret = vsnprintf_(buffer, size, format, va);
       va_end(va);
       return ret;
     }
@@ -235,6 +235,32 @@ static inline void _out_char(char character, void* buffer, size_t idx, size_t ma
 
 
 
+#ifndef PRINTF_CHUNK_SIZE
+#define PRINTF_CHUNK_SIZE 64U
+#endif
+
+// chunk used as buffer by printf_, sent to _putchar_buf each time it is full
+typedef struct {
+  char data[PRINTF_CHUNK_SIZE];
+  size_t len;
+} out_chunk_type;
+
+
+// internal chunk output
+static inline void _out_chunk(char character, void* buffer, size_t idx, size_t maxlen)
+{
+  (void)idx; (void)maxlen;
+  if (character) {
+    out_chunk_type* chunk = (out_chunk_type*)buffer;
+    chunk->data[chunk->len++] = character;
+    if (chunk->len == PRINTF_CHUNK_SIZE) {
+      _putchar_buf(chunk->data, chunk->len);
+      chunk->len = 0U;
+    }
+  }
+}
+
+
 // internal output function wrapper
 static inline void _out_fct(char character, void* buffer, size_t idx, size_t maxlen)
 {
@@ -368,11 +394,36 @@ static size_t _ntoa_long(out_fct_type out, char* buffer, size_t idx, size_t maxl
 
   // write if precision != 0 and value is != 0
   if (!(flags & FLAGS_PRECISION) || value) {
-    do {
-      const char digit = (char)(value % base);
-      buf[len++] = digit < 10 ? '0' + digit : (flags & FLAGS_UPPERCASE ? 'A' : 'a') + digit - 10;
-      value /= base;
-    } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    if (base == 10U) {
+      // two digits per division by a constant
+      const char* pairs = bsp_decimalPairs();
+      while (value >= 100U) {
+        const char* pair = pairs + 2U * (value % 100U);
+        value /= 100U;
+        buf[len++] = pair[1];
+        buf[len++] = pair[0];
+      }
+      buf[len++] = pairs[2U * value + 1U];
+      if (value >= 10U) {
+        buf[len++] = pairs[2U * value];
+      }
+    }
+    else if (!(base & (base - 1U))) {
+      // power of two bases are shifts and masks, no division
+      const char* digits = (flags & FLAGS_UPPERCASE) ? "0123456789ABCDEF" : "0123456789abcdef";
+      const unsigned int shift = base == 16U ? 4U : base == 8U ? 3U : 1U;
+      do {
+        buf[len++] = digits[value & (base - 1U)];
+        value >>= shift;
+      } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    }
+    else {
+      do {
+        const char digit = (char)(value % base);
+        buf[len++] = digit < 10 ? '0' + digit : (flags & FLAGS_UPPERCASE ? 'A' : 'a') + digit - 10;
+        value /= base;
+      } while (value && (len < PRINTF_NTOA_BUFFER_SIZE));
+    }
   }
 
   return _ntoa_format(out, buffer, idx, maxlen, buf, len, negative, (unsigned int)base, prec, width, flags);
@@ -487,18 +538,18 @@ static size_t _ftoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, d
     }
   }
   else {
+    // now do fractional part, as an unsigned number, two digits at a time
+    const char* pairs = bsp_decimalPairs();
     unsigned int count = prec;
-    // now do fractional part, as an unsigned number
-    while (len < PRINTF_FTOA_BUFFER_SIZE) {
-      --count;
-      buf[len++] = (char)(48U + (frac % 10U));
-      if (!(frac /= 10U)) {
-        break;
-      }
+    while ((count >= 2U) && (len + 2U <= PRINTF_FTOA_BUFFER_SIZE)) {
+      const char* pair = pairs + 2U * (frac % 100U);
+      frac /= 100U;
+      buf[len++] = pair[1];
+      buf[len++] = pair[0];
+      count -= 2U;
     }
-    // add extra 0s
-    while ((len < PRINTF_FTOA_BUFFER_SIZE) && (count-- > 0U)) {
-      buf[len++] = '0';
+    if (count && (len < PRINTF_FTOA_BUFFER_SIZE)) {
+      buf[len++] = (char)(48U + frac % 10U);
     }
     if (len < PRINTF_FTOA_BUFFER_SIZE) {
       // add decimal
@@ -507,10 +558,12 @@ static size_t _ftoa(out_fct_type out, char* buffer, size_t idx, size_t maxlen, d
   }
 
   // do whole part, number is reversed
-  while (len < PRINTF_FTOA_BUFFER_SIZE) {
-    buf[len++] = (char)(48 + (whole % 10));
-    if (!(whole /= 10)) {
-      break;
+  {
+    char digits[10];
+    char* end = digits + sizeof(digits);
+    char* p = bsp_utoa((unsigned int)whole, end);
+    while ((len < PRINTF_FTOA_BUFFER_SIZE) && (end != p)) {
+      buf[len++] = *(--end);
     }
   }
 
@@ -985,20 +1038,24 @@ static int _vsnprintf(out_fct_type out, char* buffer, const size_t maxlen, const
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static int vprintf_(const char* format, va_list va)
+{
+  // the output is sent in chunks, each one is a single call to the output sink
+  out_chunk_type chunk;
+  chunk.len = 0U;
+  const int ret = _vsnprintf(_out_chunk, (char*)&chunk, (size_t)-1, format, va);
+  if (chunk.len) {
+    _putchar_buf(chunk.data, chunk.len);
+  }
+  return ret;
+}
+
+
 static int printf_(const char* format, ...)
 {
   va_list va;
   va_start(va, format);
-#if (ENABLE_SEMIHOSTING_PRINT == 1) // if semihosting is enabled. This is to speed up the printing process by printing string instead of char
-    char buffer[MAX_STRING_BUFFER_SIZE];
-    const int ret = _vsnprintf(_out_buffer, buffer, (size_t)-1, format, va);
-    _putchar_s(buffer);
-#else
-    char buffer[1];
-    const int ret = _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
-
-#endif
-
+  const int ret = vprintf_(format, va);
   va_end(va);
   return ret;
 }
@@ -1024,13 +1081,6 @@ static int snprintf_(char* buffer, size_t count, const char* format, ...)
 }
 
 
-static int vprintf_(const char* format, va_list va)
-{
-  char buffer[1];
-  return _vsnprintf(_out_char, buffer, (size_t)-1, format, va);
-}
-
-
 static int vsnprintf_(char* buffer, size_t count, const char* format, va_list va)
 {
   return _vsnprintf(_out_buffer, buffer, count, format, va);
@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include <string.h>
+#include "type.h"
+#include "bsp.h"
+
+// Tokenized printf.
+// bsp_printf_token() places its format string in the .bsp_token section, which the
+// linker script keeps in the ELF but never loads, so the strings cost no RAM. The target
+// only sends the offset of the string in that section, followed by the raw 32-bit
+// arguments, and tool/tokenDecode.py rebuilds the text on the host from the ELF.
+//
+// Frame : BSP_TOKEN_SYNC, token, argument count, arguments, checksum
+// The token and the arguments are LEB128 encoded, the checksum is the 8-bit sum of the
+// bytes between the sync byte and itself. The sync byte is never sent by the text
+// printf, so tokenized and plain text output can share the terminal.
+//
+// Limitations :
+// - the format must be a string literal and at most BSP_TOKEN_MAX_ARGS arguments are sent
+// - float and double arguments are sent as single precision
+// - %s arguments are sent as pointers, the host resolves them from the ELF, so only
+//   constant strings can be decoded
+// - other pointer types than char* and void* should be cast to void*
+
+#define BSP_TOKEN_SYNC      0x1E
+#define BSP_TOKEN_MAX_ARGS  8
+
+    static inline u32 bsp_token_word(u32 value){
+        return value;
+    }
+
+    static inline u32 bsp_token_pointer(const void *value){
+        return (u32)value;
+    }
+
+    static inline u32 bsp_token_float(double value){
+        float f = value;
+        u32 word;
+        memcpy(&word, &f, 4);
+        return word;
+    }
+
+    static inline char *bsp_token_leb128(char *p, u32 value){
+        while(value >= 0x80){
+            *p++ = (value & 0x7F) | 0x80;
+            value >>= 7;
+        }
+        *p++ = value;
+        return p;
+    }
+
+    static void bsp_token_send(u32 token, const u32 *args, u32 argc){
+        char frame[2 + 5 + 5*BSP_TOKEN_MAX_ARGS + 1];
+        char *p = frame;
+        *p++ = BSP_TOKEN_SYNC;
+        p = bsp_token_leb128(p, token);
+        *p++ = argc;
+        for(u32 i = 0;i < argc;i++) p = bsp_token_leb128(p, args[i]);
+        u8 checksum = 0;
+        for(char *c = frame + 1;c != p;c++) checksum += *c;
+        *p++ = checksum;
+        _putchar_buf(frame, p - frame);
+    }
+
+// Argument to 32-bit word, selected on the argument type
+#define BSP_TOKEN_ARG(x) _Generic((x),          \
+        float: bsp_token_float,                 \
+        double: bsp_token_float,                \
+        char*: bsp_token_pointer,               \
+        const char*: bsp_token_pointer,         \
+        void*: bsp_token_pointer,               \
+        const void*: bsp_token_pointer,         \
+        default: bsp_token_word)(x)
+
+#define BSP_TOKEN_NARGS(...) BSP_TOKEN_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define BSP_TOKEN_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+
+#define BSP_TOKEN_MAP0()
+#define BSP_TOKEN_MAP1(a)       BSP_TOKEN_ARG(a)
+#define BSP_TOKEN_MAP2(a, ...)  BSP_TOKEN_ARG(a), BSP_TOKEN_MAP1(__VA_ARGS__)
+#define BSP_TOKEN_MAP3(a, ...)  BSP_TOKEN_ARG(a), BSP_TOKEN_MAP2(__VA_ARGS__)
+#define BSP_TOKEN_MAP4(a, ...)  BSP_TOKEN_ARG(a), BSP_TOKEN_MAP3(__VA_ARGS__)
+#define BSP_TOKEN_MAP5(a, ...)  BSP_TOKEN_ARG(a), BSP_TOKEN_MAP4(__VA_ARGS__)
+#define BSP_TOKEN_MAP6(a, ...)  BSP_TOKEN_ARG(a), BSP_TOKEN_MAP5(__VA_ARGS__)
+#define BSP_TOKEN_MAP7(a, ...)  BSP_TOKEN_ARG(a), BSP_TOKEN_MAP6(__VA_ARGS__)
+#define BSP_TOKEN_MAP8(a, ...)  BSP_TOKEN_ARG(a), BSP_TOKEN_MAP7(__VA_ARGS__)
+#define BSP_TOKEN_CAT(a, b)     BSP_TOKEN_CAT_(a, b)
+#define BSP_TOKEN_CAT_(a, b)    a##b
+
+/**
+* Tokenized equivalent of bsp_printf, the format string never reaches the target memory.
+*/
+#define bsp_printf_token(format, ...) do {                                                          \
+        static const char _bsp_token_format[] __attribute__((section(".bsp_token"))) = format;      \
+        const u32 _bsp_token_args[] = {0, BSP_TOKEN_CAT(BSP_TOKEN_MAP, BSP_TOKEN_NARGS(__VA_ARGS__))(__VA_ARGS__)}; \
+        bsp_token_send((u32)_bsp_token_format, _bsp_token_args + 1, BSP_TOKEN_NARGS(__VA_ARGS__));  \
+    } while(0)
+
+#if (ENABLE_BSP_PRINTF_TOKENIZED)
+    #undef bsp_printf
+    #define bsp_printf(...) bsp_printf_token(__VA_ARGS__)
+#endif //#if (ENABLE_BSP_PRINTF_TOKENIZED)
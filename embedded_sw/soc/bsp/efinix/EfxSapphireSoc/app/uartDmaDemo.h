@@ -0,0 +1,15 @@
+#pragma once
+
+// DMA channel streaming into the UART TX port.
+// Set UART_DMASG_PORT to the dmasg output port wired to the UART when the SoC is generated with the DMA,
+// otherwise the demo falls back to the interrupt driven ring buffer.
+#if defined(SYSTEM_DMASG_CTRL) && defined(UART_DMASG_PORT)
+    #define UART_DMASG_CTRL SYSTEM_DMASG_CTRL
+    #define UART_DMASG_CHANNEL 0
+    #define UART_DMASG_PLIC_INTERRUPT SYSTEM_PLIC_SYSTEM_DMASG_INTERRUPTS_0
+#else
+    #define UART_DMASG_CTRL 0
+    #define UART_DMASG_CHANNEL 0
+    #undef  UART_DMASG_PORT
+    #define UART_DMASG_PORT 0
+#endif
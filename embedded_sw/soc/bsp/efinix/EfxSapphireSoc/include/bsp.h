@@ -76,11 +76,13 @@
 // Printf related
 // There are 3 supported printf type
 // 1. bsp_print, bsp_printHex, bsp_printHexDigit, bsp_printHexByte, bsp_printReg, bsp_putString and bsp_putChar. Not recommended for new designs.
-// 2. bsp_printf - supports only char, string, decimal and hexadecimal specifier. Also provides print_float and print_dec functions. Uses the medium RAM resources.
+// 2. bsp_printf - supports only char, string, decimal and hexadecimal specifier. Also provides bsp_snprintf, print_float and print_dec functions. Uses the medium RAM resources.
 // 3. bsp_printf_full - full supports for printf including flags and precisions. Uses the most RAM resources.
+// bsp_printf_token sends the format string index and the raw arguments, the text is rebuilt on the host with tool/tokenDecode.py.
 #define ENABLE_BSP_PRINT                    1 // backward compatible printf //Default: Enable
 #define ENABLE_BSP_PRINTF                   1 // small unified printf       //Default: Enable
 #define ENABLE_BSP_PRINTF_FULL              0 // full unified printf        //Default: Disable
+#define ENABLE_BSP_PRINTF_TOKENIZED         0 // bsp_printf as bsp_printf_token //Default: Disable
 #define ENABLE_SEMIHOSTING_PRINT            0 // Enable semihosting         //Default: Disable
 
 //Printf Supports Enable
@@ -94,7 +96,81 @@
 #define ENABLE_PRINTF_WARNING               1 // Print warning when the specifier not supported. Default: Enable
 
 
+    // Output sink
+    // Every bsp print function ends in _putchar_buf, which hands whole runs of characters to
+    // the sink selected with bsp_setOutputSink. Without a sink, the output goes straight to
+    // the UART terminal, or to the debugger when ENABLE_SEMIHOSTING_PRINT is set.
+    // Sinks provided : bsp_sinkUart, bsp_sinkSemihosting, uartTx_sink (interrupt driven
+    // ring buffer, uartTx.h) and uartDma_sink (DMA, uartDma.h).
+    typedef void (*bsp_sink)(void *arg, const char *p, uint32_t len);
+
+    static bsp_sink bsp_outputSink = 0;
+    static void *bsp_outputSinkArg = 0;
+
+    /**
+    * Redirect the print functions output, null to restore the default output
+    *
+    * @param sink called with each run of characters
+    * @param arg user argument given to sink, for eg the UartTx or UartDma_Sink instance
+    */
+    static void bsp_setOutputSink(bsp_sink sink, void *arg)
+    {
+        bsp_outputSinkArg = arg;
+        bsp_outputSink = sink;
+    }
+
+    // Direct UART write, one status read per FIFO burst
+    static void bsp_sinkUart(void *arg, const char *p, uint32_t len)
+    {
+        (void)arg;
+        uart_writeBuf(BSP_UART_TERMINAL, p, len);
+    }
+
+    #ifndef BSP_SINK_SEMIHOSTING_CHUNK
+    #define BSP_SINK_SEMIHOSTING_CHUNK 64
+    #endif
+
+    // Semihosting write, one debugger call per chunk instead of one per character
+    static void bsp_sinkSemihosting(void *arg, const char *p, uint32_t len)
+    {
+        char chunk[BSP_SINK_SEMIHOSTING_CHUNK + 1];
+        uint32_t fill = 0;
+
+        (void)arg;
+        while (len--) {
+            char c = *(p++);
+            if (c)
+                chunk[fill++] = c;
+            if (fill && (!c || fill == BSP_SINK_SEMIHOSTING_CHUNK || !len)) {
+                chunk[fill] = 0;
+                sh_write0(chunk);
+                fill = 0;
+            }
+            // sh_write0 stops at null characters, send them one by one
+            if (!c)
+                sh_writec(0);
+        }
+    }
+
+    // Write len characters in bursts, one UART status read per burst
+    static void _putchar_buf(const char *p, uint32_t len)
+    {
+        if (bsp_outputSink) {
+            bsp_outputSink(bsp_outputSinkArg, p, len);
+            return;
+        }
+    #if (ENABLE_SEMIHOSTING_PRINT == 1)
+        bsp_sinkSemihosting(0, p, len);
+    #else
+        uart_writeBuf(BSP_UART_TERMINAL, p, len);
+    #endif // (ENABLE_SEMIHOSTING_PRINT == 1)
+    }
+
     static void _putchar(char character){
+        if (bsp_outputSink) {
+            bsp_outputSink(bsp_outputSinkArg, &character, 1);
+            return;
+        }
         #if (ENABLE_SEMIHOSTING_PRINT == 1)
             sh_writec(character);
         #else
@@ -104,11 +180,17 @@
 
     static void _putchar_s(char *p)
     {
+        if (bsp_outputSink) {
+            uint32_t len = 0;
+            while (p[len])
+                len++;
+            bsp_outputSink(bsp_outputSinkArg, p, len);
+            return;
+        }
     #if (ENABLE_SEMIHOSTING_PRINT == 1)
         sh_write0(p);
     #else
-        while (*p)
-            _putchar(*(p++));
+        uart_writeStr(BSP_UART_TERMINAL, p);
     #endif // (ENABLE_SEMIHOSTING_PRINT == 1)
     }
 
@@ -116,25 +198,54 @@
     //bsp_printHex is used in BSP_PRINTF
     static void bsp_printHex(uint32_t val)
     {
-        uint32_t digits;
-        digits =8;
+        char buffer[8];
 
-        for (int i = (4*digits)-4; i >= 0; i -= 4) {
-            _putchar("0123456789ABCDEF"[(val >> i) % 16]);
+        for (int i = 0; i < 8; i++) {
+            buffer[i] = "0123456789ABCDEF"[(val >> (28 - 4*i)) % 16];
         }
+        _putchar_buf(buffer, 8);
     }
 
     static void bsp_printHex_lower(uint32_t val)
         {
-            uint32_t digits;
-            digits =8;
-
-            for (int i = (4*digits)-4; i >= 0; i -= 4) {
-                _putchar("0123456789abcdef"[(val >> i) % 16]);
+            char buffer[8];
 
+            for (int i = 0; i < 8; i++) {
+                buffer[i] = "0123456789abcdef"[(val >> (28 - 4*i)) % 16];
             }
+            _putchar_buf(buffer, 8);
         }
 
+    // "00" to "99", used to convert decimal numbers two digits at a time
+    static inline const char *bsp_decimalPairs()
+    {
+        static const char pairs[201] =
+            "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+            "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+        return pairs;
+    }
+
+    // Write val in decimal, ending at end, and return the first character. Needs up to 10 characters.
+    static char *bsp_utoa(uint32_t val, char *end)
+    {
+        const char *pairs = bsp_decimalPairs();
+        char *p = end;
+        while (val >= 100) {
+            const char *pair = pairs + 2*(val % 100);
+            val /= 100;
+            *(--p) = pair[1];
+            *(--p) = pair[0];
+        }
+        if (val >= 10) {
+            *(--p) = pairs[2*val + 1];
+            *(--p) = pairs[2*val];
+        } else {
+            *(--p) = '0' + val;
+        }
+        return p;
+    }
+
 
 #if (ENABLE_BSP_PRINT)
     static void bsp_print(uint8_t * data) {
@@ -185,4 +296,8 @@
 #include "print_full.h"
 #endif //#if (ENABLE_BSP_PRINTF_FULL)
 
+#if (ENABLE_BSP_PRINTF_TOKENIZED)
+    #include "print_token.h"
+#endif //#if (ENABLE_BSP_PRINTF_TOKENIZED)
+
 
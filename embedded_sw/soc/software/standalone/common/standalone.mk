@@ -11,6 +11,18 @@ CFLAGS += ${CFLAGS_ARGS}
 CFLAGS += -I${STANDALONE}/include
 CFLAGS += -I${STANDALONE}/driver
 LDFLAGS += -L${STANDALONE}/common
+# Boot image of the SPI flash bootloader, see tool/README-bootImage.txt
+# It needs python3 and a bootloader rebuilt into the SoC RAM init, so it is only built on request
+BOOT_IMAGE ?= no
+BOOT_IMAGE_TOOL ?= ${STANDALONE}/../../tool/bootImage.py
+BOOT_IMAGE_ARGS ?=
+
+# The bootloader zeroes the .bss of boot images, start.S can skip it
+BSS_INIT ?= yes
+ifeq ($(BSS_INIT),no)
+    CFLAGS += -DNO_BSS_INIT
+endif
+
 LDFLAGS += -specs=nosys.specs -lgcc -nostartfiles -ffreestanding -Wl,-Bstatic,-T,$(LDSCRIPT),-Map,$(OBJDIR)/$(PROJ_NAME).map,--print-memory-usage -lm
 
 DOT:= .
@@ -25,6 +37,13 @@ OBJS := $(OBJS:.s=.o)
 OBJS := $(addprefix $(OBJDIR)/obj_files/,$(OBJS))
 
 all: $(OBJDIR)/$(PROJ_NAME).elf $(OBJDIR)/$(PROJ_NAME).hex $(OBJDIR)/$(PROJ_NAME).asm $(OBJDIR)/$(PROJ_NAME).bin
+ifeq ($(BOOT_IMAGE),yes)
+ifeq ($(shell command -v python3),)
+$(warning python3 not found, $(PROJ_NAME).img is not built)
+else
+all: $(OBJDIR)/$(PROJ_NAME).img
+endif
+endif
 
 $(OBJDIR)/%.elf: $(OBJS) | $(OBJDIR)
 	@echo "LD $(PROJ_NAME)"
@@ -36,6 +55,9 @@ $(OBJDIR)/%.elf: $(OBJS) | $(OBJDIR)
 %.bin: %.elf
 	@$(RISCV_OBJCOPY) -O binary $^ $@
 
+%.img: %.elf
+	@python3 $(BOOT_IMAGE_TOOL) -e $^ -o $@ $(BOOT_IMAGE_ARGS)
+
 %.v: %.elf
 	@$(RISCV_OBJCOPY) -O verilog $^ $@
 
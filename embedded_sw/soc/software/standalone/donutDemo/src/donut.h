@@ -0,0 +1,515 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include "type.h"
+
+// Spinning ASCII torus.
+// Three renderers draw the same donut up to rounding: donut_renderFloat() calls sinf/cosf for
+// every sample, donut_renderRotation() gets the same sines and cosines in floating point by
+// rotating them from one sample to the next, and donut_renderFixed() only uses Q16 integer math
+// and a quarter-wave sine table, so it runs the same on SoCs built without the FPU.
+//
+// Angles are integers, DONUT_ANGLE_TURN units make a full turn. The sample steps and the
+// rotation steps are given in these units, so both renderers walk the exact same angles.
+//
+// The geometry cache renderer, donut_renderCachedSlice(), takes its output size, sample steps
+// and character ramp from a Donut_Config, so they can be changed at runtime. DONUT_WIDTH and
+// DONUT_HEIGHT are the largest size and the frame row pitch, DONUT_THETA_STEP and DONUT_PHI_STEP
+// the finest steps. The other renderers always use these defaults.
+// This file has no hardware dependency, it can be compiled on a host as well.
+
+#define DONUT_WIDTH         80
+#define DONUT_HEIGHT        22
+#define DONUT_SIZE          (DONUT_WIDTH*DONUT_HEIGHT)
+
+#define DONUT_ANGLE_BITS    12
+#define DONUT_ANGLE_TURN    (1 << DONUT_ANGLE_BITS)
+#define DONUT_ANGLE_MASK    (DONUT_ANGLE_TURN-1)
+#define DONUT_QUARTER       (DONUT_ANGLE_TURN/4)
+
+// Sample steps around the tube (theta) and around the torus (phi), about 0.07 and 0.02 rad
+#define DONUT_THETA_STEP    46
+#define DONUT_PHI_STEP      13
+// Number of theta and phi samples in a frame
+#define DONUT_THETA_COUNT   ((DONUT_ANGLE_TURN + DONUT_THETA_STEP - 1)/DONUT_THETA_STEP)
+#define DONUT_PHI_COUNT     ((DONUT_ANGLE_TURN + DONUT_PHI_STEP - 1)/DONUT_PHI_STEP)
+// Rotation of each frame around the x (A) and z (B) axes, about 0.04 and 0.02 rad
+#define DONUT_A_STEP        26
+#define DONUT_B_STEP        13
+
+#define DONUT_Q             16
+#define DONUT_ONE           (1 << DONUT_Q)
+
+#define DONUT_RAMP          ".,-~:;=!*#$@"
+#define DONUT_RAMP_MAX      32
+
+// Coarsest sample step, 16 samples per turn
+#define DONUT_STEP_MAX      (DONUT_ANGLE_TURN/16)
+
+// Data cache line, the tiles and the geometry arrays are aligned on it
+#ifdef SYSTEM_CORES_0_BYTES_PER_LINE
+#define DONUT_LINE_BYTES    SYSTEM_CORES_0_BYTES_PER_LINE
+#else
+#define DONUT_LINE_BYTES    64
+#endif
+// Number of s32 entries rounded up to whole cache lines
+#define DONUT_LINES(count)  (((count) + DONUT_LINE_BYTES/4 - 1) & ~(DONUT_LINE_BYTES/4 - 1))
+
+// Set to 0 to leave the floating point renderer out, for SoCs without FPU
+#ifndef DONUT_FLOAT
+#define DONUT_FLOAT         1
+#endif
+
+// sin(k * 2pi / DONUT_ANGLE_TURN) in Q16, for k in [0, DONUT_QUARTER]
+static s32 donut_sinTable[DONUT_QUARTER+1];
+
+// Fill the quarter-wave table by rotating a Q30 unit vector, so no floating point is needed
+static void donut_init(){
+    // cos and sin of one angle unit in Q30
+    const s64 cosStep = 1073740561;
+    const s64 sinStep = 1647099;
+    s64 c = 1 << 30, s = 0;
+    for(u32 k = 0;k <= DONUT_QUARTER;k++){
+        donut_sinTable[k] = (s32)((s + (1 << 13)) >> 14);
+        s64 nc = (c*cosStep - s*sinStep + (1 << 29)) >> 30;
+        s = (s*cosStep + c*sinStep + (1 << 29)) >> 30;
+        c = nc;
+    }
+    donut_sinTable[DONUT_QUARTER] = DONUT_ONE;
+}
+
+static inline s32 donut_sin(u32 angle){
+    u32 index = angle & (DONUT_QUARTER-1);
+    switch((angle >> (DONUT_ANGLE_BITS-2)) & 3){
+    case 0: return donut_sinTable[index];
+    case 1: return donut_sinTable[DONUT_QUARTER-index];
+    case 2: return -donut_sinTable[index];
+    default: return -donut_sinTable[DONUT_QUARTER-index];
+    }
+}
+
+static inline s32 donut_cos(u32 angle){
+    return donut_sin(angle + DONUT_QUARTER);
+}
+
+// Q16 product
+static inline s32 donut_mul(s32 a, s32 b){
+    return (s32)(((s64)a*b) >> DONUT_Q);
+}
+
+static void donut_clear(char *frame){
+    for(u32 i = 0;i < DONUT_SIZE;i++) frame[i] = ' ';
+}
+
+// Private frame and z-buffer of one hart, aligned on cache lines so harts never share a line
+typedef struct {
+    s32 zBuffer[DONUT_SIZE];
+    char frame[DONUT_SIZE];
+} __attribute__((aligned(DONUT_LINE_BYTES))) Donut_Tile;
+
+static void donut_clearTile(Donut_Tile *tile){
+    donut_clear(tile->frame);
+    for(u32 i = 0;i < DONUT_SIZE;i++) tile->zBuffer[i] = 0;
+}
+
+/**
+* Render a range of theta samples with Q16 integer math, on top of what the frame already holds
+*
+* @param frame DONUT_SIZE characters, row by row
+* @param zBuffer DONUT_SIZE entries, holds 1/z in Q16
+* @param a rotation around the x axis, in angle units
+* @param b rotation around the z axis, in angle units
+* @param thetaFirst first theta sample index
+* @param thetaEnd theta sample index after the last one, at most DONUT_THETA_COUNT
+*/
+static void donut_renderFixedSlice(char *frame, s32 *zBuffer, u32 a, u32 b, u32 thetaFirst, u32 thetaEnd){
+    s32 sinA = donut_sin(a), cosA = donut_cos(a);
+    s32 sinB = donut_sin(b), cosB = donut_cos(b);
+
+    for(u32 theta = thetaFirst*DONUT_THETA_STEP;theta < thetaEnd*DONUT_THETA_STEP;theta += DONUT_THETA_STEP){
+        s32 sinTheta = donut_sin(theta), cosTheta = donut_cos(theta);
+        // Distance of the tube circle point to the torus axis
+        s32 h = cosTheta + 2*DONUT_ONE;
+        s32 sinThetaSinA = donut_mul(sinTheta, sinA);
+        s32 sinThetaCosA = donut_mul(sinTheta, cosA);
+        for(u32 phi = 0;phi < DONUT_ANGLE_TURN;phi += DONUT_PHI_STEP){
+            s32 sinPhi = donut_sin(phi), cosPhi = donut_cos(phi);
+            s32 sinPhiH = donut_mul(sinPhi, h);
+            s32 cosPhiH = donut_mul(cosPhi, h);
+            // 1/z, the denominator is at least 1 so the division can't overflow
+            s32 d = 0xFFFFFFFFu / (u32)(donut_mul(sinPhiH, sinA) + sinThetaCosA + 5*DONUT_ONE);
+            s32 t = donut_mul(sinPhiH, cosA) - sinThetaSinA;
+            s32 x = 40 + ((30*donut_mul(d, donut_mul(cosPhiH, cosB) - donut_mul(t, sinB))) >> DONUT_Q);
+            s32 y = 12 + ((15*donut_mul(d, donut_mul(cosPhiH, sinB) + donut_mul(t, cosB))) >> DONUT_Q);
+            if(y <= 0 || y >= DONUT_HEIGHT || x <= 0 || x >= DONUT_WIDTH) continue;
+            u32 o = x + DONUT_WIDTH*y;
+            if(d <= zBuffer[o]) continue;
+            s32 sinPhiCosTheta = donut_mul(sinPhi, cosTheta);
+            s32 n = donut_mul(sinThetaSinA - donut_mul(sinPhiCosTheta, cosA), cosB)
+                  - donut_mul(sinPhiCosTheta, sinA) - sinThetaCosA - donut_mul(donut_mul(cosPhi, cosTheta), sinB);
+            n = (8*n) >> DONUT_Q;
+            zBuffer[o] = d;
+            frame[o] = DONUT_RAMP[n > 0 ? n : 0];
+        }
+    }
+}
+
+// Render one frame with Q16 integer math
+static void donut_renderFixed(char *frame, s32 *zBuffer, u32 a, u32 b){
+    donut_clear(frame);
+    for(u32 i = 0;i < DONUT_SIZE;i++) zBuffer[i] = 0;
+    donut_renderFixedSlice(frame, zBuffer, a, b, 0, DONUT_THETA_COUNT);
+}
+
+// Torus geometry, computed once. The torus is the tube circle (theta) swept around the z axis
+// (phi), so its points and normals are products of a theta term and a phi term : only these
+// terms are stored, one array each, instead of 6 arrays of DONUT_THETA_COUNT*DONUT_PHI_COUNT.
+typedef struct {
+    s32 thetaSin[DONUT_LINES(DONUT_THETA_COUNT)];
+    s32 thetaCos[DONUT_LINES(DONUT_THETA_COUNT)];
+    s32 phiSin[DONUT_LINES(DONUT_PHI_COUNT)];
+    s32 phiCos[DONUT_LINES(DONUT_PHI_COUNT)];
+} __attribute__((aligned(DONUT_LINE_BYTES))) Donut_Geometry;
+
+// Phi terms rotated by the angles of one frame, everything the inner loop reads
+typedef struct {
+    s32 sinPhiSinA[DONUT_LINES(DONUT_PHI_COUNT)];
+    s32 sinPhiCosA[DONUT_LINES(DONUT_PHI_COUNT)];
+    s32 cosPhiCosB[DONUT_LINES(DONUT_PHI_COUNT)];
+    s32 cosPhiSinB[DONUT_LINES(DONUT_PHI_COUNT)];
+    // Luminance term multiplied by cos(theta)
+    s32 normal[DONUT_LINES(DONUT_PHI_COUNT)];
+    s32 sinA, cosA, sinB, cosB;
+} __attribute__((aligned(DONUT_LINE_BYTES))) Donut_Transform;
+
+// Runtime settings of the geometry cache renderer, only changed through the donut_config functions
+typedef struct {
+    // Output size, the frame keeps a row pitch of DONUT_WIDTH
+    u32 width, height;
+    // Projection, the donut is centered and scaled to the output size
+    s32 centerX, centerY, scaleX, scaleY;
+    // Sample steps and number of samples, in angle units
+    u32 thetaStep, phiStep;
+    u32 thetaCount, phiCount;
+    // Luminance to ramp index factor, in Q4
+    u32 rampScale;
+    u32 rampLength;
+    char ramp[DONUT_RAMP_MAX+1];
+} Donut_Config;
+
+/**
+* Set the output size
+*
+* @return 0 if the size is out of range, the config is then unchanged
+*/
+static u32 donut_configSize(Donut_Config *config, u32 width, u32 height){
+    if(width < 8 || width > DONUT_WIDTH || height < 4 || height > DONUT_HEIGHT) return 0;
+    config->width = width;
+    config->height = height;
+    // Characters are about twice as high as wide, 80x22 gives the classic 40+30x, 12+15y
+    s32 scale = width*3/8;
+    if(scale > (s32)(height*15/11)) scale = height*15/11;
+    config->centerX = width/2;
+    config->centerY = (height+2)/2;
+    config->scaleX = scale;
+    config->scaleY = scale/2;
+    return 1;
+}
+
+/**
+* Set the sample steps, the geometry has to be initialized again with donut_geometryInit()
+*
+* @return 0 if a step is finer than the default one or coarser than DONUT_STEP_MAX, the config is then unchanged
+*/
+static u32 donut_configSteps(Donut_Config *config, u32 thetaStep, u32 phiStep){
+    if(thetaStep < DONUT_THETA_STEP || thetaStep > DONUT_STEP_MAX || phiStep < DONUT_PHI_STEP || phiStep > DONUT_STEP_MAX) return 0;
+    config->thetaStep = thetaStep;
+    config->phiStep = phiStep;
+    config->thetaCount = (DONUT_ANGLE_TURN + thetaStep - 1)/thetaStep;
+    config->phiCount = (DONUT_ANGLE_TURN + phiStep - 1)/phiStep;
+    return 1;
+}
+
+/**
+* Set the character ramp, from the darkest to the brightest character
+*
+* @return 0 if the ramp is shorter than 2 or longer than DONUT_RAMP_MAX characters, the config is then unchanged
+*/
+static u32 donut_configRamp(Donut_Config *config, const char *ramp, u32 length){
+    if(length < 2 || length > DONUT_RAMP_MAX) return 0;
+    for(u32 i = 0;i < length;i++) config->ramp[i] = ramp[i];
+    config->ramp[length] = 0;
+    config->rampLength = length;
+    // The luminance is at most sqrt(2), 8 per unit for the 12 characters of DONUT_RAMP
+    config->rampScale = 128*length/12;
+    return 1;
+}
+
+// Default settings, the same size, steps and ramp as donut_renderFixed(). The geometry cache
+// renderer then draws the same donut, but not the same frames: the cached terms round differently
+// and about 0.1% of the lit cells get another character.
+static void donut_configInit(Donut_Config *config){
+    donut_configSize(config, DONUT_WIDTH, DONUT_HEIGHT);
+    donut_configSteps(config, DONUT_THETA_STEP, DONUT_PHI_STEP);
+    donut_configRamp(config, DONUT_RAMP, sizeof(DONUT_RAMP)-1);
+}
+
+static void donut_geometryInit(Donut_Geometry *geometry, const Donut_Config *config){
+    for(u32 i = 0;i < config->thetaCount;i++){
+        geometry->thetaSin[i] = donut_sin(i*config->thetaStep);
+        geometry->thetaCos[i] = donut_cos(i*config->thetaStep);
+    }
+    for(u32 j = 0;j < config->phiCount;j++){
+        geometry->phiSin[j] = donut_sin(j*config->phiStep);
+        geometry->phiCos[j] = donut_cos(j*config->phiStep);
+    }
+}
+
+static void donut_transformInit(Donut_Transform *transform, const Donut_Geometry *geometry, const Donut_Config *config, u32 a, u32 b){
+    s32 sinA = donut_sin(a), cosA = donut_cos(a);
+    s32 sinB = donut_sin(b), cosB = donut_cos(b);
+    transform->sinA = sinA;
+    transform->cosA = cosA;
+    transform->sinB = sinB;
+    transform->cosB = cosB;
+    for(u32 j = 0;j < config->phiCount;j++){
+        s32 sinPhi = geometry->phiSin[j], cosPhi = geometry->phiCos[j];
+        s32 sinPhiSinA = donut_mul(sinPhi, sinA);
+        s32 sinPhiCosA = donut_mul(sinPhi, cosA);
+        s32 cosPhiSinB = donut_mul(cosPhi, sinB);
+        transform->sinPhiSinA[j] = sinPhiSinA;
+        transform->sinPhiCosA[j] = sinPhiCosA;
+        transform->cosPhiCosB[j] = donut_mul(cosPhi, cosB);
+        transform->cosPhiSinB[j] = cosPhiSinB;
+        transform->normal[j] = donut_mul(sinPhiCosA, cosB) + sinPhiSinA + cosPhiSinB;
+    }
+}
+
+/**
+* Render a range of theta samples from the geometry cache, same math as donut_renderFixedSlice()
+* with the phi terms of the frame read from the transform arrays
+*
+* @param frame DONUT_SIZE characters, row by row
+* @param zBuffer DONUT_SIZE entries, holds 1/z in Q16
+* @param geometry torus geometry
+* @param config settings the geometry was initialized with
+* @param transform phi terms of the frame, from donut_transformInit()
+* @param thetaFirst first theta sample index
+* @param thetaEnd theta sample index after the last one, at most config->thetaCount
+*/
+static void donut_renderCachedSlice(char *frame, s32 *zBuffer, const Donut_Geometry *geometry, const Donut_Config *config, const Donut_Transform *transform, u32 thetaFirst, u32 thetaEnd){
+    s32 sinA = transform->sinA, cosA = transform->cosA;
+    s32 sinB = transform->sinB, cosB = transform->cosB;
+    s32 width = config->width, height = config->height;
+    s32 centerX = config->centerX, centerY = config->centerY;
+    s32 scaleX = config->scaleX, scaleY = config->scaleY;
+    s32 rampScale = config->rampScale;
+    u32 phiCount = config->phiCount;
+
+    for(u32 i = thetaFirst;i < thetaEnd;i++){
+        s32 sinTheta = geometry->thetaSin[i], cosTheta = geometry->thetaCos[i];
+        s32 h = cosTheta + 2*DONUT_ONE;
+        s32 sinThetaSinA = donut_mul(sinTheta, sinA);
+        s32 sinThetaCosA = donut_mul(sinTheta, cosA);
+        s32 normalTheta = donut_mul(sinThetaSinA, cosB) - sinThetaCosA;
+        for(u32 j = 0;j < phiCount;j++){
+            s32 d = 0xFFFFFFFFu / (u32)(donut_mul(h, transform->sinPhiSinA[j]) + sinThetaCosA + 5*DONUT_ONE);
+            s32 t = donut_mul(h, transform->sinPhiCosA[j]) - sinThetaSinA;
+            s32 x = centerX + ((scaleX*donut_mul(d, donut_mul(h, transform->cosPhiCosB[j]) - donut_mul(t, sinB))) >> DONUT_Q);
+            s32 y = centerY + ((scaleY*donut_mul(d, donut_mul(h, transform->cosPhiSinB[j]) + donut_mul(t, cosB))) >> DONUT_Q);
+            if(y <= 0 || y >= height || x <= 0 || x >= width) continue;
+            u32 o = x + DONUT_WIDTH*y;
+            if(d <= zBuffer[o]) continue;
+            // Same index as 8*luminance for the default ramp, always below rampLength
+            s32 n = (rampScale*(normalTheta - donut_mul(cosTheta, transform->normal[j]))) >> (DONUT_Q+4);
+            zBuffer[o] = d;
+            frame[o] = config->ramp[n > 0 ? n : 0];
+        }
+    }
+}
+
+// First theta sample of the slice of a hart, slices are contiguous and in hart order
+static u32 donut_sliceFirst(u32 hart, u32 hartCount, u32 thetaCount){
+    return hart*thetaCount/hartCount;
+}
+
+/**
+* Combine the tiles rendered from consecutive theta slices, each cell keeps the nearest sample.
+* Ties go to the lowest tile, like in a single pass over all the samples, so the result is
+* identical to a single donut_renderCachedSlice() call over all the theta samples.
+*
+* @param frame DONUT_SIZE characters receiving the merged frame
+* @param tiles tiles in slice order
+* @param count number of tiles
+* @param first first cell to merge, to split the merge between harts
+* @param end cell after the last one to merge
+*/
+static void donut_merge(char *frame, const Donut_Tile *tiles, u32 count, u32 first, u32 end){
+    for(u32 o = first;o < end;o++){
+        s32 z = tiles[0].zBuffer[o];
+        char c = tiles[0].frame[o];
+        for(u32 t = 1;t < count;t++){
+            if(tiles[t].zBuffer[o] > z){
+                z = tiles[t].zBuffer[o];
+                c = tiles[t].frame[o];
+            }
+        }
+        frame[o] = c;
+    }
+}
+
+#if (DONUT_FLOAT == 1)
+#include <math.h>
+
+#define DONUT_RADIAN    (6.28318530718f/DONUT_ANGLE_TURN)
+
+/**
+* Render one frame with floating point math and libm, sample by sample
+*
+* @param frame DONUT_SIZE characters, row by row
+* @param zBuffer DONUT_SIZE entries, holds 1/z
+* @param a rotation around the x axis, in angle units
+* @param b rotation around the z axis, in angle units
+*/
+static void donut_renderFloat(char *frame, float *zBuffer, u32 a, u32 b){
+    float e = sinf(a*DONUT_RADIAN), g = cosf(a*DONUT_RADIAN);
+    float m = cosf(b*DONUT_RADIAN), n = sinf(b*DONUT_RADIAN);
+
+    donut_clear(frame);
+    for(u32 i = 0;i < DONUT_SIZE;i++) zBuffer[i] = 0;
+
+    for(u32 theta = 0;theta < DONUT_ANGLE_TURN;theta += DONUT_THETA_STEP){
+        for(u32 phi = 0;phi < DONUT_ANGLE_TURN;phi += DONUT_PHI_STEP){
+            float c = sinf(phi*DONUT_RADIAN), l = cosf(phi*DONUT_RADIAN);
+            float d = cosf(theta*DONUT_RADIAN), f = sinf(theta*DONUT_RADIAN);
+            float h = d + 2;
+            float D = 1/(c*h*e + f*g + 5);
+            float t = c*h*g - f*e;
+            s32 x = 40 + 30*D*(l*h*m - t*n);
+            s32 y = 12 + 15*D*(l*h*n + t*m);
+            s32 o = x + DONUT_WIDTH*y;
+            s32 N = 8*((f*e - c*d*g)*m - c*d*e - f*g - l*d*n);
+            if(DONUT_HEIGHT > y && y > 0 && x > 0 && DONUT_WIDTH > x && D > zBuffer[o]){
+                zBuffer[o] = D;
+                frame[o] = DONUT_RAMP[N > 0 ? N : 0];
+            }
+        }
+    }
+}
+
+// Recompute the rotated sine/cosine pairs with sinf/cosf every DONUT_RESYNC steps. Renormalizing
+// them only stops the drift of the norm, the rounding of the step sine and cosine still shifts the
+// angle, by up to 2.6e-3 after 1e6 steps. See tool/donutRotationCheck.c.
+#define DONUT_RESYNC        64
+
+// Sine and cosine of an angle which advances by a constant step, from the angle addition identity
+typedef struct {
+    float sin, cos;
+    float stepSin, stepCos;
+    u32 angle, step; // in angle units
+    u32 steps;
+} Donut_Rotation;
+
+static void donut_rotationInit(Donut_Rotation *rotation, u32 angle, u32 step){
+    rotation->sin = sinf((angle & DONUT_ANGLE_MASK)*DONUT_RADIAN);
+    rotation->cos = cosf((angle & DONUT_ANGLE_MASK)*DONUT_RADIAN);
+    rotation->stepSin = sinf(step*DONUT_RADIAN);
+    rotation->stepCos = cosf(step*DONUT_RADIAN);
+    rotation->angle = angle;
+    rotation->step = step;
+    rotation->steps = 0;
+}
+
+static inline void donut_rotationAdvance(Donut_Rotation *rotation){
+    float s = rotation->sin, c = rotation->cos;
+    rotation->angle += rotation->step;
+    if(++rotation->steps == DONUT_RESYNC){
+        rotation->sin = sinf((rotation->angle & DONUT_ANGLE_MASK)*DONUT_RADIAN);
+        rotation->cos = cosf((rotation->angle & DONUT_ANGLE_MASK)*DONUT_RADIAN);
+        rotation->steps = 0;
+        return;
+    }
+    rotation->sin = s*rotation->stepCos + c*rotation->stepSin;
+    rotation->cos = c*rotation->stepCos - s*rotation->stepSin;
+}
+
+/**
+* Render one frame with floating point math, the sample sines and cosines are rotated
+* from one sample to the next instead of calling libm
+*
+* @param frame DONUT_SIZE characters, row by row
+* @param zBuffer DONUT_SIZE entries, holds 1/z
+* @param a rotation around the x axis
+* @param b rotation around the z axis
+*/
+static void donut_renderRotation(char *frame, float *zBuffer, const Donut_Rotation *a, const Donut_Rotation *b){
+    float e = a->sin, g = a->cos;
+    float m = b->cos, n = b->sin;
+    Donut_Rotation theta, phi;
+
+    donut_clear(frame);
+    for(u32 i = 0;i < DONUT_SIZE;i++) zBuffer[i] = 0;
+
+    donut_rotationInit(&theta, 0, DONUT_THETA_STEP);
+    donut_rotationInit(&phi, 0, DONUT_PHI_STEP);
+    for(u32 i = 0;i < DONUT_THETA_COUNT;i++){
+        float d = theta.cos, f = theta.sin;
+        float h = d + 2;
+        phi.sin = 0;
+        phi.cos = 1;
+        phi.angle = 0;
+        phi.steps = 0;
+        for(u32 j = 0;j < DONUT_ANGLE_TURN;j += DONUT_PHI_STEP){
+            float c = phi.sin, l = phi.cos;
+            float D = 1/(c*h*e + f*g + 5);
+            float t = c*h*g - f*e;
+            s32 x = 40 + 30*D*(l*h*m - t*n);
+            s32 y = 12 + 15*D*(l*h*n + t*m);
+            s32 o = x + DONUT_WIDTH*y;
+            s32 N = 8*((f*e - c*d*g)*m - c*d*e - f*g - l*d*n);
+            if(DONUT_HEIGHT > y && y > 0 && x > 0 && DONUT_WIDTH > x && D > zBuffer[o]){
+                zBuffer[o] = D;
+                frame[o] = DONUT_RAMP[N > 0 ? N : 0];
+            }
+            donut_rotationAdvance(&phi);
+        }
+        donut_rotationAdvance(&theta);
+    }
+}
+#endif
@@ -0,0 +1,296 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include "type.h"
+#include "donut.h"
+#include "crc32.h"
+
+// Compressed frame stream, decoded and displayed on the host by tool/donutViewer.c.
+// The cells of the output area (Donut_Config size, row by row) are coded with one byte per run :
+//     0x01-0x3F  1 to 63 spaces
+//     0x40-0x7F  skip 1 to 64 cells, they keep the value of the previous frame
+//     0x80-0xFF  ramp character (code & 0x1F) repeated ((code >> 5) & 3) + 1 times
+// The ramp is the static dictionary of the stream, sent with each key frame.
+//
+// Frames are sent between two 0x00 delimiters, like the telemetry frames (driver/telemetry.h) :
+//     0x00, type, sequence, [header], codes, check, 0x00
+// No byte of a frame is 0x00, so the host splits them from the text console output without
+// any escaping. The sequence is 0x80 | a 7 bits counter. The check is the CRC32 of the decoded
+// cells, row by row, in 5 bytes of 7 bits from the lowest ones, with 0x80 set.
+//   'K' key frame, the header is width, height, ramp length and the ramp characters, no skip code
+//   'D' delta frame, no header, only decoded on top of the frame of the previous sequence
+// A key frame is sent every DONUT_COMPRESS_KEY frames and each time the size or the ramp change,
+// so the host recovers from a lost frame.
+// This file has no hardware dependency, it can be compiled on a host as well.
+
+#define DONUT_COMPRESS_KEY      32
+#define DONUT_COMPRESS_HEADER   3
+// Largest compressed frame : delimiters, type, sequence, header, ramp, one code per cell and check
+#define DONUT_COMPRESS_MAX      (5 + DONUT_COMPRESS_HEADER + DONUT_RAMP_MAX + DONUT_SIZE + 5)
+
+#define DONUT_COMPRESS_SPACE    0x00
+#define DONUT_COMPRESS_SKIP     0x40
+#define DONUT_COMPRESS_RAMP     0x80
+
+typedef struct {
+    char previous[DONUT_SIZE];
+    u32 valid;
+    u32 sequence;
+    u32 sinceKey;
+    // Size and ramp of the last key frame
+    u32 width, height;
+    u32 rampLength;
+    char ramp[DONUT_RAMP_MAX];
+    u8 symbol[256];
+} Donut_Compressor;
+
+typedef struct {
+    // Decoded frame, row pitch of DONUT_WIDTH like the target frames
+    char frame[DONUT_SIZE];
+    char next[DONUT_SIZE];
+    u32 valid;
+    u32 sequence;
+    u32 width, height;
+    u32 rampLength;
+    char ramp[DONUT_RAMP_MAX];
+    // Statistics
+    u32 keyFrames, deltaFrames, errors, lost;
+} Donut_Decompressor;
+
+// The next frame is a key frame
+static void donut_compressReset(Donut_Compressor *compressor){
+    compressor->valid = 0;
+}
+
+// Next cell of the output area, the frame rows are DONUT_WIDTH apart
+static inline u32 donut_compressNext(u32 o, u32 *x, u32 width){
+    if(++*x == width){
+        *x = 0;
+        return o + 1 + DONUT_WIDTH - width;
+    }
+    return o + 1;
+}
+
+// Output area CRC32, the check of the frames
+static u32 donut_compressCheck(const char *frame, u32 width, u32 height){
+    u32 crc = CRC32_INIT;
+    for(u32 y = 0;y < height;y++) crc = crc32_update(crc, frame + y*DONUT_WIDTH, width);
+    return crc32_final(crc);
+}
+
+/**
+* Compress a frame
+*
+* @param compressor holds the frame the host shows
+* @param config size and ramp the frame was rendered with
+* @param frame new frame
+* @param out receives the bytes to send, delimiters included, at least DONUT_COMPRESS_MAX bytes
+*
+* @return number of bytes written in out
+*/
+static u32 donut_compress(Donut_Compressor *compressor, const Donut_Config *config, const char *frame, u8 *out){
+    u32 width = config->width, height = config->height;
+    u32 key = !compressor->valid || compressor->sinceKey == DONUT_COMPRESS_KEY-1
+           || width != compressor->width || height != compressor->height || config->rampLength != compressor->rampLength;
+    for(u32 i = 0;i < config->rampLength && !key;i++) key = config->ramp[i] != compressor->ramp[i];
+
+    u8 *p = out;
+    *p++ = 0;
+    *p++ = key ? 'K' : 'D';
+    *p++ = DONUT_COMPRESS_RAMP | (compressor->sequence++ & 0x7F);
+    if(key){
+        compressor->width = width;
+        compressor->height = height;
+        compressor->rampLength = config->rampLength;
+        compressor->sinceKey = 0;
+        *p++ = width;
+        *p++ = height;
+        *p++ = config->rampLength;
+        for(u32 i = 0;i < 256;i++) compressor->symbol[i] = DONUT_COMPRESS_RAMP;
+        for(u32 i = 0;i < config->rampLength;i++){
+            compressor->ramp[i] = config->ramp[i];
+            compressor->symbol[(u8)config->ramp[i]] = DONUT_COMPRESS_RAMP | i;
+            *p++ = config->ramp[i];
+        }
+    } else {
+        compressor->sinceKey++;
+    }
+
+    const char *previous = compressor->previous;
+    u32 left = width*height;
+    u32 o = 0, x = 0;
+    while(left){
+        char cell = frame[o];
+        u32 run = 0;
+        if(!key && cell == previous[o]){
+            do {
+                run++;
+                o = donut_compressNext(o, &x, width);
+            } while(run < 64 && run < left && frame[o] == previous[o]);
+            *p++ = DONUT_COMPRESS_SKIP + run - 1;
+        } else if(cell == ' '){
+            do {
+                run++;
+                o = donut_compressNext(o, &x, width);
+            } while(run < 63 && run < left && frame[o] == ' ');
+            *p++ = DONUT_COMPRESS_SPACE + run;
+        } else {
+            do {
+                run++;
+                o = donut_compressNext(o, &x, width);
+            } while(run < 4 && run < left && frame[o] == cell);
+            *p++ = compressor->symbol[(u8)cell] | (run - 1) << 5;
+        }
+        left -= run;
+    }
+
+    u32 check = donut_compressCheck(frame, width, height);
+    for(u32 i = 0;i < 5;i++) *p++ = DONUT_COMPRESS_RAMP | ((check >> 7*i) & 0x7F);
+    *p++ = 0;
+
+    for(u32 i = 0;i < DONUT_SIZE;i++) compressor->previous[i] = frame[i];
+    compressor->valid = 1;
+    return p - out;
+}
+
+static void donut_decompressInit(Donut_Decompressor *decompressor){
+    donut_clear(decompressor->frame);
+    decompressor->valid = 0;
+    decompressor->sequence = 0;
+    decompressor->width = 0;
+    decompressor->height = 0;
+    decompressor->rampLength = 0;
+    decompressor->keyFrames = 0;
+    decompressor->deltaFrames = 0;
+    decompressor->errors = 0;
+    decompressor->lost = 0;
+}
+
+// Decode the header and the codes of a frame, then its check. Only updates the decoded frame when they are all valid
+static u32 donut_decompressFrame(Donut_Decompressor *decompressor, const u8 *p, const u8 *end, u32 key){
+    u32 width = decompressor->width, height = decompressor->height;
+    u32 rampLength = decompressor->rampLength;
+    const char *ramp = decompressor->ramp;
+    char *next = decompressor->next;
+    if(key){
+        if(end - p < DONUT_COMPRESS_HEADER) return 0;
+        width = p[0];
+        height = p[1];
+        rampLength = p[2];
+        ramp = (const char*)p + DONUT_COMPRESS_HEADER;
+        p += DONUT_COMPRESS_HEADER + rampLength;
+        if(width > DONUT_WIDTH || height > DONUT_HEIGHT || rampLength > DONUT_RAMP_MAX || p > end) return 0;
+        donut_clear(next);
+    } else {
+        for(u32 i = 0;i < DONUT_SIZE;i++) next[i] = decompressor->frame[i];
+    }
+
+    u32 left = width*height;
+    u32 o = 0, x = 0;
+    while(p != end){
+        u8 code = *p++;
+        u32 run;
+        char cell = 0;
+        if(code >= DONUT_COMPRESS_RAMP){
+            run = ((code >> 5) & 3) + 1;
+            if((code & 0x1F) >= rampLength) return 0;
+            cell = ramp[code & 0x1F];
+        } else if(code >= DONUT_COMPRESS_SKIP){
+            if(key) return 0;
+            run = code - DONUT_COMPRESS_SKIP + 1;
+        } else {
+            run = code - DONUT_COMPRESS_SPACE;
+            cell = ' ';
+        }
+        if(run > left) return 0;
+        left -= run;
+        while(run--){
+            if(cell) next[o] = cell;
+            o = donut_compressNext(o, &x, width);
+        }
+    }
+    u32 check = 0;
+    for(u32 i = 0;i < 5;i++) check |= (u32)(end[i] & 0x7F) << 7*i;
+    if(left || check != donut_compressCheck(next, width, height)) return 0;
+
+    for(u32 i = 0;i < DONUT_SIZE;i++) decompressor->frame[i] = next[i];
+    if(key){
+        decompressor->width = width;
+        decompressor->height = height;
+        decompressor->rampLength = rampLength;
+        for(u32 i = 0;i < rampLength;i++) decompressor->ramp[i] = ramp[i];
+    }
+    return 1;
+}
+
+/**
+* Decode a frame received between two 0x00 delimiters
+*
+* @param decompressor holds the last decoded frame
+* @param data frame content, without the delimiters
+* @param length frame content size in bytes
+*
+* @return 1 if decompressor->frame was updated, 0 for a broken frame or a delta frame which can't be decoded
+*/
+static u32 donut_decompress(Donut_Decompressor *decompressor, const u8 *data, u32 length){
+    if(length < 2 + 5 || (data[0] != 'K' && data[0] != 'D')){
+        decompressor->errors++;
+        decompressor->valid = 0;
+        return 0;
+    }
+    u32 key = data[0] == 'K';
+    u32 sequence = data[1] & 0x7F;
+    if(decompressor->valid && sequence != ((decompressor->sequence + 1) & 0x7F)){
+        decompressor->lost += (sequence - decompressor->sequence - 1) & 0x7F;
+        decompressor->valid = 0;
+    }
+    decompressor->sequence = sequence;
+    // A delta frame needs the frame of the previous sequence, wait for the next key frame
+    if(!key && !decompressor->valid) return 0;
+
+    if(donut_decompressFrame(decompressor, data + 2, data + length - 5, key)){
+        decompressor->valid = 1;
+        if(key) decompressor->keyFrames++;
+        else decompressor->deltaFrames++;
+    } else {
+        decompressor->errors++;
+        decompressor->valid = 0;
+    }
+    return decompressor->valid;
+}
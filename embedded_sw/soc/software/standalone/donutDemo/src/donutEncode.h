@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include "type.h"
+#include "donut.h"
+
+// Terminal encoding of the donut frames.
+// donut_encodeFull() repaints the whole frame from the home position. donut_encodeDelta()
+// compares the frame with the previous one and only sends the changed cells, moving the
+// cursor with ANSI sequences : CUP "ESC[<row>;<column>H" to change row, or CUF "ESC[<n>C"
+// to skip forward on the same row. Short runs of unchanged cells are written again when
+// that is cheaper than a jump. When the delta isn't smaller than a full repaint, the full
+// repaint is sent instead.
+
+// Bytes of a full repaint, also the largest encoded frame
+#define DONUT_ENCODE_FULL   (3 + DONUT_HEIGHT*(DONUT_WIDTH + 2))
+
+typedef struct {
+    char previous[DONUT_SIZE];
+    u32 valid;
+} Donut_Encoder;
+
+// Forget the terminal content, the next frame is a full repaint
+static void donut_encoderReset(Donut_Encoder *encoder){
+    encoder->valid = 0;
+}
+
+static u32 donut_encodeFull(Donut_Encoder *encoder, const char *frame, char *out){
+    char *p = out;
+    *p++ = '\x1b'; *p++ = '['; *p++ = 'H';
+    for(u32 y = 0;y < DONUT_HEIGHT;y++){
+        for(u32 x = 0;x < DONUT_WIDTH;x++) *p++ = frame[y*DONUT_WIDTH + x];
+        *p++ = '\r'; *p++ = '\n';
+    }
+    for(u32 i = 0;i < DONUT_SIZE;i++) encoder->previous[i] = frame[i];
+    encoder->valid = 1;
+    return p - out;
+}
+
+static u32 donut_encodeDigits(u32 value){
+    return value >= 100 ? 3 : value >= 10 ? 2 : 1;
+}
+
+static char *donut_encodeDec(char *p, u32 value){
+    if(value >= 100) *p++ = '0' + value/100;
+    if(value >= 10) *p++ = '0' + value/10%10;
+    *p++ = '0' + value%10;
+    return p;
+}
+
+/**
+* Encode the cells which changed since the previous frame, or the whole frame when it is cheaper
+*
+* @param encoder holds the frame the terminal shows
+* @param frame new frame
+* @param out receives the bytes to send, at least DONUT_ENCODE_FULL bytes
+*
+* @return number of bytes written in out
+*/
+static u32 donut_encodeDelta(Donut_Encoder *encoder, const char *frame, char *out){
+    if(!encoder->valid) return donut_encodeFull(encoder, frame, out);
+
+    char *p = out;
+    // Worst case growth of a single cell : CUP with 2 digit row and column, then the cell
+    char *limit = out + DONUT_ENCODE_FULL - 9;
+    // Cursor position on the terminal, row DONUT_HEIGHT means unknown
+    u32 row = DONUT_HEIGHT, column = 0;
+    for(u32 y = 0;y < DONUT_HEIGHT;y++){
+        const char *line = frame + y*DONUT_WIDTH;
+        const char *previous = encoder->previous + y*DONUT_WIDTH;
+        for(u32 x = 0;x < DONUT_WIDTH;x++){
+            if(line[x] == previous[x]) continue;
+            if(p >= limit) return donut_encodeFull(encoder, frame, out);
+            u32 jump = 4 + donut_encodeDigits(y+1) + donut_encodeDigits(x+1);
+            if(row == y && column <= x){
+                u32 gap = x - column;
+                u32 forward = 3 + donut_encodeDigits(gap);
+                if(gap <= forward && gap <= jump){
+                    // Rewrite the unchanged cells, the terminal already shows them
+                    for(;column < x;column++) *p++ = line[column];
+                } else if(forward < jump){
+                    *p++ = '\x1b'; *p++ = '[';
+                    p = donut_encodeDec(p, gap);
+                    *p++ = 'C';
+                    column = x;
+                }
+            }
+            if(row != y || column != x){
+                *p++ = '\x1b'; *p++ = '[';
+                p = donut_encodeDec(p, y+1);
+                *p++ = ';';
+                p = donut_encodeDec(p, x+1);
+                *p++ = 'H';
+            }
+            *p++ = line[x];
+            row = y;
+            column = x + 1;
+            // Writing the last column leaves the terminal waiting to wrap, force a CUP
+            if(column == DONUT_WIDTH) row = DONUT_HEIGHT;
+        }
+    }
+    if(p - out >= DONUT_ENCODE_FULL) return donut_encodeFull(encoder, frame, out);
+    for(u32 i = 0;i < DONUT_SIZE;i++) encoder->previous[i] = frame[i];
+    return p - out;
+}
@@ -0,0 +1,833 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#include <stdint.h>
+#include "bsp.h"
+#include "clint.h"
+#include "uart.h"
+#include "riscv.h"
+#include "plic.h"
+#include "soc.h"
+#include "start.h"
+#include "smpDemo.h"
+#include "donut.h"
+#include "donutEncode.h"
+#include "donutCompress.h"
+#include "uartRx.h"
+#include "crc32.h"
+
+// Spinning donut, rendered with floating point math and libm, with floating point math and
+// rotated sines/cosines, then with Q16 integer math. The renderers are first timed alone and
+// with the frames sent to the terminal, the frames per second are printed side by side, then
+// the donut spins with the fixed point renderer. Build with DONUT_FLOAT=no to leave the
+// floating point renderers out.
+//
+// The fixed point renderer runs on all the harts, from the torus geometry cache (Donut_Geometry).
+// For each frame, each hart rotates the cached phi terms into its own Donut_Transform, renders a
+// slice of the theta samples into its own tile, then merges a range of rows of all the tiles
+// into the frame. The speedup is measured with 1 to HART_COUNT harts.
+//
+// The frames are sent to the terminal either as full repaints or as deltas of the previous
+// frame (donutEncode.h), the bytes per frame and the frames per second of both are printed.
+// The compressed output (donutCompress.h) codes the cells as runs of spaces, runs of unchanged
+// cells and runs of ramp characters, in binary frames which tool/donutViewer.c decodes and
+// draws on the host. It isn't sent during the benchmarks, as a terminal can't show it : its
+// bytes per frame are measured alone and give the frames per second at the UART baudrate.
+//
+// With more than one hart, the rendering and the transmission are pipelined : the last hart
+// sends frame N from one buffer while the other harts render frame N+1 into the other buffer.
+// The buffers are handed over with two counters incremented by amoadd, produced by the render
+// side and consumed by the transmit side. The time each side spends working and waiting for
+// the other is printed.
+//
+// The animation is paced by a frame governor : hart 0 sleeps in wfi until the CLINT compare of
+// the next frame, and skips frames when it is more than a frame late. The render and transmit
+// times of each frame go into histograms. Console commands, one per line :
+//   fps <n>   target frames per second, 0 to run as fast as possible
+//   hist      print the histograms and the dropped frames
+//   reset     clear the histograms
+//   capture [n]  headless capture of n frames, see below
+//   size <width> <height>     output size, at most DONUT_WIDTH x DONUT_HEIGHT
+//   step <theta> <phi>        finest sample steps, in 1/4096 of a turn
+//   ramp <characters>         character ramp, from the darkest to the brightest
+//   adapt <0|1>               adaptive sample density
+//   config    print the settings
+//   output <full|delta|compressed>  terminal output, compressed needs tool/donutViewer.c
+//
+// The adaptive density keeps the frames within the budget of the target frames per second : the
+// sample steps get coarser while the frames miss it, and finer again, down to the steps set on
+// the console, while there is slack. The same binary then keeps its frame rate on smaller
+// Sapphire configurations, with fewer harts or without FPU, at the cost of a sparser donut.
+//
+// The headless capture renders frames 0 to n-1 on all the harts into RAM, with no terminal
+// output, and only times the rendering : its frames per second are the compute benchmark of the
+// SoC. The CRC32 of each frame and the digest of the run, the CRC32 of all the frames back to
+// back, are printed at the end. tool/donutReference.c builds the same renderer on a host and
+// checks them, so a renderer change can be proven to leave every frame unchanged. Build with
+// DONUT_HEADLESS=yes to only run the capture at boot, without the benchmarks nor the animation.
+
+#define BENCH_FRAMES    8
+#define ENCODER_FRAMES  64
+#define CORE_HZ         BSP_CLINT_HZ
+#define UART_BAUDRATE   SYSTEM_UART_0_IO_PARAMETER_INIT_CONFIG_BAUDRATE
+
+#define GOVERNOR_FPS    20
+#define HISTOGRAM_BINS  16
+#define HISTOGRAM_BIN_US 4000
+#define CAPTURE_FRAMES  256
+#define ADAPT_WINDOW    8
+#define ADAPT_SLACK     60
+
+#ifndef DONUT_HEADLESS
+#define DONUT_HEADLESS  0
+#endif
+
+typedef void (*Renderer)(u32 a, u32 b);
+
+char frame[DONUT_SIZE];
+s32 zFixed[DONUT_SIZE];
+
+Donut_Encoder encoder;
+char txBuffer[DONUT_ENCODE_FULL];
+u32 encoderOn;
+Donut_Compressor compressor;
+u8 compressBuffer[DONUT_COMPRESS_MAX];
+u32 compressOn;
+u64 txBytes;
+
+u8 hartStack[STACK_PER_HART*HART_COUNT] __attribute__((aligned(16)));
+Donut_Tile tiles[HART_COUNT];
+Donut_Geometry geometry;
+Donut_Config config;
+Donut_Transform transforms[HART_COUNT];
+
+// Job published by hart 0, jobId changes last
+volatile u32 jobId, jobA, jobB, jobHarts;
+char * volatile jobFrame;
+volatile u32 hartCounter, renderDone, mergeDone;
+// Cycles spent by each hart, rendering its slice and merging its rows
+volatile u64 renderCycles[HART_COUNT], mergeCycles[HART_COUNT];
+
+// Render/transmit pipeline, frame n goes through pipeFrames[n & 1]
+#define TX_HART (HART_COUNT-1)
+char pipeFrames[2][DONUT_SIZE] __attribute__((aligned(64)));
+volatile u32 produced, consumed, pipelineRun, transmitDone;
+// Cycles of each side working and waiting on the other, sum of the frames queued at each transmit
+volatile u64 renderBusy, renderStall, transmitBusy, transmitStall;
+volatile u32 queueSum;
+
+// Frame governor, frame index of the animation and the frame times in CLINT ticks
+UartRx uartRx;
+u32 targetFps = GOVERNOR_FPS;
+u32 animationFrame, droppedFrames;
+u32 renderHistogram[HISTOGRAM_BINS], transmitHistogram[HISTOGRAM_BINS];
+u32 captureCrc[CAPTURE_FRAMES];
+
+//Adaptive density, the steps set on the console are the finest ones it uses
+u32 adaptive = 1;
+u32 thetaStep = DONUT_THETA_STEP, phiStep = DONUT_PHI_STEP;
+u32 adaptFrames, adaptChanges;
+u64 adaptTicks;
+
+void init();
+void trap();
+void crash();
+void trap_entry();
+void UartInterrupt();
+
+extern void smpInit();
+void mainSmp();
+
+__inline__ __attribute__((always_inline)) s32 atomicAdd(s32 *a, u32 increment) {
+    s32 old;
+    __asm__ volatile(
+          "amoadd.w %[old], %[increment], (%[atomic])"
+        : [old] "=r"(old)
+        : [increment] "r"(increment), [atomic] "r"(a)
+        : "memory"
+    );
+    return old;
+}
+
+//Share of the current job of one hart
+void renderJob(u32 hartId){
+    u32 harts = jobHarts;
+    Donut_Tile *tile = &tiles[hartId];
+
+    u32 t0 = csr_read(mcycle);
+    donut_clearTile(tile);
+    donut_transformInit(&transforms[hartId], &geometry, &config, jobA, jobB);
+    donut_renderCachedSlice(tile->frame, tile->zBuffer, &geometry, &config, &transforms[hartId],
+        donut_sliceFirst(hartId, harts, config.thetaCount), donut_sliceFirst(hartId+1, harts, config.thetaCount));
+    u32 t1 = csr_read(mcycle);
+    renderCycles[hartId] += t1 - t0;
+
+    //Wait for all the tiles before merging
+    asm("fence rw,w");
+    atomicAdd((s32*)&renderDone, 1);
+    while(renderDone != harts);
+    asm("fence r,r");
+
+    u32 rowFirst = hartId*DONUT_HEIGHT/harts;
+    u32 rowEnd = (hartId+1)*DONUT_HEIGHT/harts;
+    donut_merge(jobFrame, tiles, harts, rowFirst*DONUT_WIDTH, rowEnd*DONUT_WIDTH);
+    mergeCycles[hartId] += csr_read(mcycle) - t1;
+    asm("fence rw,w");
+    atomicAdd((s32*)&mergeDone, 1);
+}
+
+void transmitLoop();
+
+//Harts other than 0 wait for jobs, TX_HART runs the transmit side of the pipeline when asked
+void mainSmp(){
+    u32 hartId = csr_read(mhartid);
+    u32 seen = 0;
+    atomicAdd((s32*)&hartCounter, 1);
+    while(1){
+        while(jobId == seen){
+            if(hartId == TX_HART && pipelineRun){
+                transmitLoop();
+                //The jobs published meanwhile didn't include this hart
+                seen = jobId;
+                asm("fence rw,w");
+                transmitDone = 1;
+            }
+        }
+        asm("fence r,r");
+        seen = jobId;
+        if(hartId < jobHarts) renderJob(hartId);
+    }
+}
+
+//Render one frame into target with harts 0 to jobHarts-1
+void renderInto(char *target, u32 a, u32 b){
+    renderDone = 0;
+    mergeDone = 0;
+    jobFrame = target;
+    jobA = a;
+    jobB = b;
+    asm("fence w,w");
+    jobId = jobId + 1;
+    renderJob(0);
+    while(mergeDone != jobHarts);
+    asm("fence r,r");
+}
+
+void renderParallel(u32 a, u32 b){
+    renderInto(frame, a, b);
+}
+
+void renderFixed(u32 a, u32 b){
+    donut_renderFixed(frame, zFixed, a, b);
+}
+
+//Single hart render from the geometry cache
+void renderCached(u32 a, u32 b){
+    donut_clear(frame);
+    for(u32 i = 0;i < DONUT_SIZE;i++) zFixed[i] = 0;
+    donut_transformInit(&transforms[0], &geometry, &config, a, b);
+    donut_renderCachedSlice(frame, zFixed, &geometry, &config, &transforms[0], 0, config.thetaCount);
+}
+
+#if (DONUT_FLOAT == 1)
+float zFloat[DONUT_SIZE];
+
+void renderFloat(u32 a, u32 b){
+    donut_renderFloat(frame, zFloat, a, b);
+}
+
+Donut_Rotation rotationA, rotationB;
+
+//The frame angles are rotated from one frame to the next, bench() always starts from frame 0
+void renderRotation(u32 a, u32 b){
+    if(a == 0){
+        donut_rotationInit(&rotationA, 0, DONUT_A_STEP);
+        donut_rotationInit(&rotationB, 0, DONUT_B_STEP);
+    }
+    donut_renderRotation(frame, zFloat, &rotationA, &rotationB);
+    donut_rotationAdvance(&rotationA);
+    donut_rotationAdvance(&rotationB);
+}
+#endif
+
+//Frames per second times 100
+u32 fps100(u32 frames, u64 ticks){
+    return (u32)((u64)frames*CORE_HZ*100/ticks);
+}
+
+void sendFrame(const char *source){
+    u32 length;
+    if(compressOn){
+        length = donut_compress(&compressor, &config, source, compressBuffer);
+        uart_writeBuf(BSP_UART_TERMINAL, (const char *)compressBuffer, length);
+    } else {
+        length = encoderOn ? donut_encodeDelta(&encoder, source, txBuffer) : donut_encodeFull(&encoder, source, txBuffer);
+        uart_writeBuf(BSP_UART_TERMINAL, txBuffer, length);
+    }
+    txBytes += length;
+}
+
+void showFrame(){
+    sendFrame(frame);
+}
+
+void histogramAdd(u32 *histogram, u32 ticks){
+    u32 bin = ticks/(HISTOGRAM_BIN_US*(CORE_HZ/1000000));
+    histogram[bin < HISTOGRAM_BINS ? bin : HISTOGRAM_BINS-1]++;
+}
+
+//Clear the terminal, the encoder has to start again from a full repaint
+void clearScreen(){
+    bsp_printf("\x1b[2J\x1b[H");
+    donut_encoderReset(&encoder);
+    donut_compressReset(&compressor);
+}
+
+//Transmit side of the pipeline, returns once pipelineRun is cleared and every frame is sent
+void transmitLoop(){
+    while(1){
+        u32 t0 = csr_read(mcycle);
+        while(produced == consumed){
+            if(!pipelineRun){
+                asm("fence r,r");
+                if(produced == consumed) return;
+            }
+        }
+        asm("fence r,r");
+        u32 t1 = csr_read(mcycle);
+        u32 start = clint_getTimeLow(BSP_CLINT);
+        queueSum += produced - consumed;
+        sendFrame(pipeFrames[consumed & 1]);
+        histogramAdd(transmitHistogram, clint_getTimeLow(BSP_CLINT) - start);
+        transmitStall += t1 - t0;
+        transmitBusy += csr_read(mcycle) - t1;
+        //Give the buffer back to the render side
+        asm("fence rw,w");
+        atomicAdd((s32*)&consumed, 1);
+    }
+}
+
+//Start the transmit side on TX_HART, the render side runs on harts 0 to TX_HART-1
+void pipelineStart(){
+    renderBusy = 0;
+    renderStall = 0;
+    transmitBusy = 0;
+    transmitStall = 0;
+    queueSum = 0;
+    produced = 0;
+    consumed = 0;
+    transmitDone = 0;
+    jobHarts = HART_COUNT-1;
+    asm("fence w,w");
+    pipelineRun = 1;
+}
+
+//Render a frame into the free buffer and queue it for the transmit side, returns the render ticks
+u32 pipelineRender(u32 index){
+    u32 t0 = csr_read(mcycle);
+    //Both buffers are queued, wait for the transmit side
+    while(produced - consumed == 2);
+    asm("fence r,r");
+    u32 t1 = csr_read(mcycle);
+    u32 start = clint_getTimeLow(BSP_CLINT);
+    renderInto(pipeFrames[produced & 1], index*DONUT_A_STEP, index*DONUT_B_STEP);
+    u32 ticks = clint_getTimeLow(BSP_CLINT) - start;
+    renderStall += t1 - t0;
+    renderBusy += csr_read(mcycle) - t1;
+    asm("fence w,w");
+    atomicAdd((s32*)&produced, 1);
+    return ticks;
+}
+
+//Wait for the transmit side to send every queued frame and to leave the pipeline
+void pipelineStop(){
+    asm("fence w,w");
+    pipelineRun = 0;
+    while(!transmitDone);
+    asm("fence r,r");
+}
+
+//Pipelined frames as fast as possible, returns the frames per second times 100
+u32 runPipeline(u32 count){
+    pipelineStart();
+    u64 start = clint_getTime(BSP_CLINT);
+    for(u32 i = 0;i < count;i++) pipelineRender(i);
+    pipelineStop();
+    return fps100(count, clint_getTime(BSP_CLINT) - start);
+}
+
+//Share of the time spent working, in percent
+u32 busyPercent(u64 busy, u64 stall){
+    return (u32)(busy*100/(busy + stall));
+}
+
+//Results of the terminal output benchmarks, printed once they are all done
+u32 encoderFps[2], encoderBytes[2], pipelineFps, pipelineQueue;
+u32 compressBytes, compressCycles;
+
+void benchPipeline(){
+    clearScreen();
+    pipelineFps = runPipeline(ENCODER_FRAMES);
+    pipelineQueue = queueSum*100/ENCODER_FRAMES;
+}
+
+void printPipeline(){
+    bsp_printf("pipelined    : %d.%d%d fps, render busy %d percent, transmit busy %d percent, %d.%d%d frames queued on average\r\n",
+        pipelineFps/100, pipelineFps/10%10, pipelineFps%10, busyPercent(renderBusy, renderStall),
+        busyPercent(transmitBusy, transmitStall), pipelineQueue/100, pipelineQueue/10%10, pipelineQueue%10);
+}
+
+u32 bench(Renderer render, u32 show, u32 frames){
+    u64 t0 = clint_getTime(BSP_CLINT);
+    for(u32 i = 0;i < frames;i++){
+        render(i*DONUT_A_STEP, i*DONUT_B_STEP);
+        if(show) showFrame();
+    }
+    return fps100(frames, clint_getTime(BSP_CLINT) - t0);
+}
+
+//Cycles of one frame from its frames per second times 100
+u32 frameCycles(u32 fps){
+    return (u32)((u64)CORE_HZ*100/fps);
+}
+
+void printFps(const char *name, u32 renderFps, u32 showFps){
+    bsp_printf("%s %d.%d%d fps render only, %d.%d%d fps with the terminal output\r\n", name,
+        renderFps/100, renderFps/10%10, renderFps%10, showFps/100, showFps/10%10, showFps%10);
+}
+
+//Render only benchmark of the parallel renderer with 1 to HART_COUNT harts
+void benchHarts(){
+    u32 fps[HART_COUNT];
+    for(u32 harts = 1;harts <= HART_COUNT;harts++){
+        jobHarts = harts;
+        for(u32 i = 0;i < HART_COUNT;i++){
+            renderCycles[i] = 0;
+            mergeCycles[i] = 0;
+        }
+        fps[harts-1] = bench(renderParallel, 0, BENCH_FRAMES);
+        u32 speedup = fps[harts-1]*100/fps[0];
+        bsp_printf("%d hart(s) : %d.%d%d fps, speedup %d.%d%d, cycles per frame render/merge :", harts,
+            fps[harts-1]/100, fps[harts-1]/10%10, fps[harts-1]%10, speedup/100, speedup/10%10, speedup%10);
+        for(u32 i = 0;i < harts;i++){
+            bsp_printf(" h%d %d/%d", i, (u32)(renderCycles[i]/BENCH_FRAMES), (u32)(mergeCycles[i]/BENCH_FRAMES));
+        }
+        bsp_printf("\r\n");
+    }
+}
+
+//Parallel renderer with the terminal output, full repaints then deltas
+void benchEncoder(){
+    for(u32 on = 0;on < 2;on++){
+        clearScreen();
+        encoderOn = on;
+        txBytes = 0;
+        encoderFps[on] = bench(renderParallel, 1, ENCODER_FRAMES);
+        encoderBytes[on] = txBytes/ENCODER_FRAMES;
+    }
+    encoderOn = 1;
+
+    //Compressed frames, only encoded
+    u32 bytes = 0, cycles = 0;
+    donut_compressReset(&compressor);
+    for(u32 i = 0;i < ENCODER_FRAMES;i++){
+        renderParallel(i*DONUT_A_STEP, i*DONUT_B_STEP);
+        u32 t0 = csr_read(mcycle);
+        bytes += donut_compress(&compressor, &config, frame, compressBuffer);
+        cycles += csr_read(mcycle) - t0;
+    }
+    donut_compressReset(&compressor);
+    compressBytes = bytes/ENCODER_FRAMES;
+    compressCycles = cycles/ENCODER_FRAMES;
+}
+
+void printEncoder(){
+    for(u32 on = 0;on < 2;on++){
+        bsp_printf("%s : %d bytes per frame, %d.%d%d fps\r\n", on ? "delta frames" : "full frames ",
+            encoderBytes[on], encoderFps[on]/100, encoderFps[on]/10%10, encoderFps[on]%10);
+    }
+    //10 bits per byte on the UART
+    u32 ratio = encoderBytes[0]*100/compressBytes;
+    u32 fps = UART_BAUDRATE*10/compressBytes;
+    bsp_printf("compressed   : %d bytes per frame, %d.%d%d times less than full frames, %d cycles per frame to compress, UART limit %d.%d%d fps at %d baud\r\n",
+        compressBytes, ratio/100, ratio/10%10, ratio%10, compressCycles, fps/100, fps/10%10, fps%10, UART_BAUDRATE);
+}
+
+void init(){
+    //RX FIFO not empty interrupt, the console commands are read from the uartRx ring buffer.
+    //No echo, the terminal output belongs to the frames
+    uartRx_init(&uartRx, BSP_UART_TERMINAL, 0);
+
+    //configure PLIC
+    //cpu 0 accept all interrupts with priority above 0
+    plic_set_threshold(BSP_PLIC, BSP_PLIC_CPU_0, 0);
+
+    plic_set_enable(BSP_PLIC, BSP_PLIC_CPU_0, SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, 1);
+    plic_set_priority(BSP_PLIC, SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, 1);
+
+    //The governor timer only fires when armed
+    clint_setCmp(BSP_CLINT, 0xFFFFFFFFFFFFFFFFull, 0);
+
+    //enable interrupts
+    csr_write(mtvec, trap_entry); //Set the machine trap vector (../common/trap.S)
+    csr_set(mie, MIE_MEIE | MIE_MTIE); //Enable external and timer interrupts
+    csr_write(mstatus, csr_read(mstatus) | MSTATUS_MPP | MSTATUS_MIE);
+}
+
+//Called by trap_entry on both exceptions and interrupts events
+void trap(){
+    int32_t mcause = csr_read(mcause);
+    //Interrupt if set, exception if cleared
+    int32_t interrupt = mcause < 0;
+    int32_t cause     = mcause & 0xF;
+
+    if(interrupt){
+        switch(cause){
+        //The governor deadline is reached, disarm the timer, wfi returned already
+        case CAUSE_MACHINE_TIMER: clint_setCmp(BSP_CLINT, 0xFFFFFFFFFFFFFFFFull, 0); break;
+        case CAUSE_MACHINE_EXTERNAL: UartInterrupt(); break;
+        default: crash(); break;
+        }
+    } else {
+        crash();
+    }
+}
+
+void UartInterrupt()
+{
+    uint32_t claim;
+    //While there is pending interrupts
+    while(claim = plic_claim(BSP_PLIC, BSP_PLIC_CPU_0)){
+        switch(claim){
+        case SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT: uartRx_interrupt(&uartRx); break;
+        default: crash(); break;
+        }
+        //unmask the claimed interrupt
+        plic_release(BSP_PLIC, BSP_PLIC_CPU_0, claim);
+    }
+}
+
+void crash(){
+    bsp_printf("\r\n*** CRASH ***\r\n");
+    while(1);
+}
+
+//Change the sample steps of the geometry cache, only between frames as the harts read it
+u32 setSteps(u32 theta, u32 phi){
+    if(!donut_configSteps(&config, theta, phi)) return 0;
+    donut_geometryInit(&geometry, &config);
+    return 1;
+}
+
+/**
+* Adaptive density, compares the average frame time of every ADAPT_WINDOW frames to the budget.
+* The steps get about 1/8 coarser when the budget is missed, and 1/8 finer, down to the steps set
+* on the console, when less than ADAPT_SLACK percent of it is used. A coarser step saves about 20
+* percent, so the density doesn't swing back and forth between two settings.
+*
+* @param ticks time of the last frame
+* @param budget time of a frame at the target frames per second, 0 to not adapt
+*/
+void adapt(u32 ticks, u64 budget){
+    if(!adaptive || !budget) return;
+    adaptTicks += ticks;
+    if(++adaptFrames != ADAPT_WINDOW) return;
+    u64 average = adaptTicks/ADAPT_WINDOW;
+    adaptTicks = 0;
+    adaptFrames = 0;
+
+    u32 theta = config.thetaStep, phi = config.phiStep;
+    if(average > budget){
+        theta += theta/8 + 1;
+        phi += phi/8 + 1;
+        if(theta > DONUT_STEP_MAX) theta = DONUT_STEP_MAX;
+        if(phi > DONUT_STEP_MAX) phi = DONUT_STEP_MAX;
+    } else if(average < budget*ADAPT_SLACK/100){
+        theta -= theta/9 + 1;
+        phi -= phi/9 + 1;
+        if(theta < thetaStep) theta = thetaStep;
+        if(phi < phiStep) phi = phiStep;
+    }
+    if(theta != config.thetaStep || phi != config.phiStep){
+        setSteps(theta, phi);
+        adaptChanges++;
+    }
+}
+
+//Sleep until the CLINT reaches deadline
+void governorSleep(u64 deadline){
+    clint_setCmp(BSP_CLINT, deadline, 0);
+    while(1){
+        //Check with interrupts masked, an interrupt pending before the wfi still wakes it up
+        csr_clear(mstatus, MSTATUS_MIE);
+        if(clint_getTime(BSP_CLINT) >= deadline) break;
+        asm volatile("wfi");
+        csr_set(mstatus, MSTATUS_MIE);
+    }
+    csr_set(mstatus, MSTATUS_MIE);
+}
+
+/**
+* Animate at targetFps until a console command is received
+*
+* @param line set to the command
+* @param length set to the command length
+*/
+void animate(const char **line, u32 *length){
+    u64 period = targetFps ? CORE_HZ/targetFps : 0;
+    u64 next = clint_getTime(BSP_CLINT);
+    adaptTicks = 0;
+    adaptFrames = 0;
+#if (HART_COUNT > 1)
+    pipelineStart();
+#else
+    jobHarts = 1;
+#endif
+    while(!uartRx_line(&uartRx, line, length)){
+        if(period){
+            u64 now = clint_getTime(BSP_CLINT);
+            //More than a frame late, skip the frames which can't be on time anymore
+            if(now >= next + period){
+                u32 late = (now - next)/period;
+                animationFrame += late;
+                droppedFrames += late;
+                next += late*period;
+            }
+            if(now < next) governorSleep(next);
+            next += period;
+        }
+#if (HART_COUNT > 1)
+        //The transmission runs alongside on TX_HART, only the rendering has to fit in the budget
+        u32 ticks = pipelineRender(animationFrame);
+        histogramAdd(renderHistogram, ticks);
+        adapt(ticks, period);
+#else
+        u32 t0 = clint_getTimeLow(BSP_CLINT);
+        renderParallel(animationFrame*DONUT_A_STEP, animationFrame*DONUT_B_STEP);
+        u32 t1 = clint_getTimeLow(BSP_CLINT);
+        showFrame();
+        u32 t2 = clint_getTimeLow(BSP_CLINT);
+        histogramAdd(renderHistogram, t1 - t0);
+        histogramAdd(transmitHistogram, t2 - t1);
+        adapt(t2 - t0, period);
+#endif
+        animationFrame++;
+    }
+#if (HART_COUNT > 1)
+    pipelineStop();
+#endif
+}
+
+void histogramReset(){
+    for(u32 i = 0;i < HISTOGRAM_BINS;i++){
+        renderHistogram[i] = 0;
+        transmitHistogram[i] = 0;
+    }
+    droppedFrames = 0;
+}
+
+void printHistogram(){
+    bsp_printf("target %d fps, %d frames dropped\r\n", targetFps, droppedFrames);
+    for(u32 i = 0;i < HISTOGRAM_BINS;i++){
+        bsp_printf("%d ms%s : render %d, transmit %d\r\n", i*HISTOGRAM_BIN_US/1000,
+            i == HISTOGRAM_BINS-1 ? " and more" : "", renderHistogram[i], transmitHistogram[i]);
+    }
+}
+
+/**
+* Headless capture, render frames 0 to count-1 on all the harts and print their CRC32
+*
+* @param count number of frames, 0 for CAPTURE_FRAMES. Only the CRC32 of the first CAPTURE_FRAMES frames are printed, all of them go into the digest
+*/
+void capture(u32 count){
+    if(!count) count = CAPTURE_FRAMES;
+    u32 digest = CRC32_INIT;
+    u64 ticks = 0;
+    jobHarts = HART_COUNT;
+    for(u32 i = 0;i < count;i++){
+        u64 t0 = clint_getTime(BSP_CLINT);
+        renderParallel(i*DONUT_A_STEP, i*DONUT_B_STEP);
+        ticks += clint_getTime(BSP_CLINT) - t0;
+        if(i < CAPTURE_FRAMES) captureCrc[i] = crc32(frame, DONUT_SIZE);
+        digest = crc32_update(digest, frame, DONUT_SIZE);
+    }
+    u32 fps = fps100(count, ticks);
+    for(u32 i = 0;i < count && i < CAPTURE_FRAMES;i++){
+        bsp_printf("frame %d crc %x\r\n", i, captureCrc[i]);
+    }
+    bsp_printf("#CAPTURE frames %d digest %x harts %d fps %d.%d%d cycles %d size %dx%d steps %d/%d\r\n", count, crc32_final(digest),
+        HART_COUNT, fps/100, fps/10%10, fps%10, frameCycles(fps), config.width, config.height, config.thetaStep, config.phiStep);
+}
+
+void printConfig(){
+    bsp_printf("size %dx%d, steps %d/%d for %dx%d samples, finest steps %d/%d, ramp %s\r\n", config.width, config.height,
+        config.thetaStep, config.phiStep, config.thetaCount, config.phiCount, thetaStep, phiStep, config.ramp);
+    bsp_printf("adaptive density %s, target %d fps, %d step changes\r\n", adaptive ? "on" : "off", targetFps, adaptChanges);
+}
+
+//Console command, the reply is printed under the donut
+void command(const char *line, u32 length){
+    const char *token;
+    u32 tokenLength = uartRx_token(&line, &length, &token);
+#if (DONUT_HEADLESS == 0)
+    bsp_printf("\x1b[%d;1H\x1b[J", DONUT_HEIGHT+2);
+#endif
+    if(uartRx_tokenIs(token, tokenLength, "fps")){
+        tokenLength = uartRx_token(&line, &length, &token);
+        targetFps = uartRx_tokenValue(token, tokenLength);
+        bsp_printf("target %d fps\r\n", targetFps);
+    } else if(uartRx_tokenIs(token, tokenLength, "hist")){
+        printHistogram();
+    } else if(uartRx_tokenIs(token, tokenLength, "reset")){
+        histogramReset();
+        bsp_printf("histograms cleared\r\n");
+    } else if(uartRx_tokenIs(token, tokenLength, "capture")){
+        tokenLength = uartRx_token(&line, &length, &token);
+        capture(uartRx_tokenValue(token, tokenLength));
+    } else if(uartRx_tokenIs(token, tokenLength, "size")){
+        tokenLength = uartRx_token(&line, &length, &token);
+        u32 width = uartRx_tokenValue(token, tokenLength);
+        tokenLength = uartRx_token(&line, &length, &token);
+        if(donut_configSize(&config, width, uartRx_tokenValue(token, tokenLength))) printConfig();
+        else bsp_printf("size from 8x4 to %dx%d\r\n", DONUT_WIDTH, DONUT_HEIGHT);
+    } else if(uartRx_tokenIs(token, tokenLength, "step")){
+        tokenLength = uartRx_token(&line, &length, &token);
+        u32 theta = uartRx_tokenValue(token, tokenLength);
+        tokenLength = uartRx_token(&line, &length, &token);
+        if(setSteps(theta, uartRx_tokenValue(token, tokenLength))){
+            thetaStep = config.thetaStep;
+            phiStep = config.phiStep;
+            printConfig();
+        } else {
+            bsp_printf("theta step from %d to %d, phi step from %d to %d\r\n", DONUT_THETA_STEP, DONUT_STEP_MAX, DONUT_PHI_STEP, DONUT_STEP_MAX);
+        }
+    } else if(uartRx_tokenIs(token, tokenLength, "ramp")){
+        tokenLength = uartRx_token(&line, &length, &token);
+        if(donut_configRamp(&config, token, tokenLength)) printConfig();
+        else bsp_printf("ramp of 2 to %d characters\r\n", DONUT_RAMP_MAX);
+    } else if(uartRx_tokenIs(token, tokenLength, "adapt")){
+        tokenLength = uartRx_token(&line, &length, &token);
+        adaptive = uartRx_tokenValue(token, tokenLength) != 0;
+        //Back to the console steps until the controller needs coarser ones again
+        setSteps(thetaStep, phiStep);
+        printConfig();
+    } else if(uartRx_tokenIs(token, tokenLength, "config")){
+        printConfig();
+    } else if(uartRx_tokenIs(token, tokenLength, "output")){
+        tokenLength = uartRx_token(&line, &length, &token);
+        compressOn = uartRx_tokenIs(token, tokenLength, "compressed");
+        encoderOn = !uartRx_tokenIs(token, tokenLength, "full");
+        //The terminal, or the viewer, starts again from a full frame
+        clearScreen();
+    } else if(tokenLength){
+        bsp_printf("commands : fps <n>, hist, reset, capture [n], size <w> <h>, step <theta> <phi>, ramp <chars>, adapt <0|1>, config, output <full|delta|compressed>\r\n");
+    }
+}
+
+void main() {
+    bsp_init();
+    init();
+    donut_init();
+    donut_configInit(&config);
+    donut_geometryInit(&geometry, &config);
+    bsp_printf("donut demo ! \r\n");
+#if (SYSTEM_CORES_0_FPU == 0)
+    bsp_printf("FPU is disabled, the floating point renderer runs on soft float \r\n");
+#endif
+
+    //Start the other harts, they wait for render jobs in mainSmp
+    atomicAdd((s32*)&hartCounter, 1);
+    smp_unlock(smpInit);
+    while(hartCounter != HART_COUNT);
+
+#if (DONUT_HEADLESS == 1)
+    capture(CAPTURE_FRAMES);
+    while(1){
+        const char *line;
+        u32 length;
+        while(!uartRx_line(&uartRx, &line, &length));
+        command(line, length);
+        uartRx_release(&uartRx);
+    }
+#else
+    clearScreen();
+#if (DONUT_FLOAT == 1)
+    u32 floatRender = bench(renderFloat, 0, BENCH_FRAMES);
+    u32 floatShow = bench(renderFloat, 1, BENCH_FRAMES);
+    u32 rotationRender = bench(renderRotation, 0, BENCH_FRAMES);
+    u32 rotationShow = bench(renderRotation, 1, BENCH_FRAMES);
+#endif
+    u32 fixedRender = bench(renderFixed, 0, BENCH_FRAMES);
+    u32 fixedShow = bench(renderFixed, 1, BENCH_FRAMES);
+    u32 cachedRender = bench(renderCached, 0, BENCH_FRAMES);
+
+    jobHarts = HART_COUNT;
+    benchEncoder();
+#if (HART_COUNT > 1)
+    benchPipeline();
+#endif
+    clearScreen();
+    printEncoder();
+#if (HART_COUNT > 1)
+    printPipeline();
+#endif
+    bsp_printf("%d frames of %dx%d characters\r\n", BENCH_FRAMES, DONUT_WIDTH, DONUT_HEIGHT);
+#if (DONUT_FLOAT == 1)
+    printFps("float          :", floatRender, floatShow);
+    printFps("float rotation :", rotationRender, rotationShow);
+    bsp_printf("rotating the sines/cosines saves %d cycles per frame\r\n",
+        frameCycles(floatRender) - frameCycles(rotationRender));
+#endif
+    printFps("fixed          :", fixedRender, fixedShow);
+    bsp_printf("fixed, cached  : %d cycles per frame, %d cycles per frame without the geometry cache\r\n",
+        frameCycles(cachedRender), frameCycles(fixedRender));
+    bsp_printf("geometry cache : %d bytes + %d bytes per hart, %d bytes of RAM in total, per sample point and normal arrays would take %d bytes\r\n",
+        sizeof(Donut_Geometry), sizeof(Donut_Transform), SYSTEM_RAM_A_SIZE, 6*4*DONUT_THETA_COUNT*DONUT_PHI_COUNT);
+    benchHarts();
+    bsp_uDelay(3000000);
+
+    clearScreen();
+    histogramReset();
+    while(1){
+        const char *line;
+        u32 length;
+        animate(&line, &length);
+        command(line, length);
+        uartRx_release(&uartRx);
+    }
+#endif
+}
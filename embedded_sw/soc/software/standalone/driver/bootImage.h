@@ -0,0 +1,193 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include "type.h"
+#include "spiFlash.h"
+#include "crc32.h"
+
+// Boot image stored in flash: a BootImage_Header followed by the payload.
+// The payload holds the data of each segment back to back, as is or compressed with the LZ4
+// block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), one block per segment.
+// tool/bootImage.py produces it from the ELF, see tool/README-bootImage.txt.
+//
+// The crc field is the crc32 of the header, with crc set to 0, followed by the payload. The bootloader
+// computes it while the payload is read from the flash, and doesn't start an image which doesn't match.
+//
+// Every field is a little endian 32 bits word.
+
+#define BOOT_IMAGE_MAGIC        0x474D4942 // "BIMG"
+#define BOOT_IMAGE_VERSION      3
+#define BOOT_IMAGE_SEGMENT_MAX  4
+#define BOOT_IMAGE_MAGIC_BITS   4          // A magic this close is a damaged header, not a plain binary
+
+#define BOOT_IMAGE_LZ4          (1 << 0)   // flags, the payload is LZ4 compressed
+
+    typedef struct {
+        u32 address;      // RAM address of the segment, word aligned
+        u32 length;       // Bytes of data once in memory, a multiple of 4
+        u32 storedLength; // Bytes of data stored in the payload
+        u32 size;         // Bytes of the segment in memory, the ones after length are zeroed (.bss)
+    } BootImage_Segment;
+
+    typedef struct {
+        u32 magic;
+        u32 version;
+        u32 flags;
+        u32 length;           // Sum of the segments length
+        u32 compressedLength; // Sum of the segments storedLength, bytes of payload after the header
+        u32 crc;              // crc32 of the header and the payload as stored in flash
+        u32 entry;            // Address the bootloader jumps to
+        u32 segmentCount;
+        BootImage_Segment segments[BOOT_IMAGE_SEGMENT_MAX];
+    } BootImage_Header;
+
+    /**
+    * Check if a header which doesn't hold BOOT_IMAGE_MAGIC still looks like a boot image:
+    * its magic is at most BOOT_IMAGE_MAGIC_BITS bits away from it, or it has the version of
+    * this bootloader. Such a flash holds a damaged image rather than a plain binary.
+    *
+    * @param header The header read from flash
+    */
+    static u32 bootImage_damaged(BootImage_Header *header){
+        u32 diff = header->magic ^ BOOT_IMAGE_MAGIC;
+        u32 bits = 0;
+        if(header->version == BOOT_IMAGE_VERSION) return 1;
+        for(;diff && bits <= BOOT_IMAGE_MAGIC_BITS;bits++) diff &= diff - 1;
+        return bits <= BOOT_IMAGE_MAGIC_BITS;
+    }
+
+    /**
+    * Check that header describes an image this bootloader can load, with every segment
+    * inside the given memory range and the entry point inside a segment
+    *
+    * @param header The header read from flash
+    * @param memoryAddress Start of the memory the image may use
+    * @param memorySize Size of the memory the image may use
+    */
+    static u32 bootImage_valid(BootImage_Header *header, u32 memoryAddress, u32 memorySize){
+        u32 length = 0, storedLength = 0, entry = 0;
+        if(header->magic != BOOT_IMAGE_MAGIC) return 0;
+        if(header->version != BOOT_IMAGE_VERSION) return 0;
+        if(header->segmentCount == 0 || header->segmentCount > BOOT_IMAGE_SEGMENT_MAX) return 0;
+        for(u32 i = 0;i < header->segmentCount;i++){
+            BootImage_Segment *segment = &header->segments[i];
+            if((segment->address | segment->length | segment->size) & 3) return 0;
+            if(segment->length > segment->size) return 0;
+            if(segment->address < memoryAddress || segment->address - memoryAddress > memorySize) return 0;
+            if(segment->size > memorySize - (segment->address - memoryAddress)) return 0;
+            if(!(header->flags & BOOT_IMAGE_LZ4) && segment->storedLength != segment->length) return 0;
+            if(header->entry - segment->address < segment->size) entry = 1;
+            length += segment->length;
+            storedLength += segment->storedLength;
+        }
+        return entry && length == header->length && storedLength == header->compressedLength;
+    }
+
+    /**
+    * CRC32 of the header with its crc field set to 0, not finalized, to be continued over the payload
+    *
+    * @param header The header read from flash
+    */
+    static u32 bootImage_headerCrc(BootImage_Header *header){
+        u8 *bytes = (u8 *) header;
+        u32 before = (u8 *) &header->crc - bytes;
+        u32 zero = 0;
+        u32 crc = crc32_update(CRC32_INIT, bytes, before);
+        crc = crc32_update(crc, &zero, 4);
+        return crc32_update(crc, bytes + before + 4, sizeof(BootImage_Header) - before - 4);
+    }
+
+    /**
+    * Zero the part of a segment which isn't stored in the image (.bss)
+    *
+    * @param segment The segment loaded
+    */
+    static void bootImage_zero(BootImage_Segment *segment){
+        u32 *word = (u32 *) (segment->address + segment->length);
+        u32 *end = (u32 *) (segment->address + segment->size);
+        while(word != end) *word++ = 0;
+    }
+
+    /**
+    * Read the extension bytes of an LZ4 literal or match length
+    *
+    * @param stream The compressed stream
+    * @param length The 4 bits length of the token
+    */
+    static u32 bootImage_lz4Length(SpiFlash_Stream *stream, u32 length){
+        u32 byte;
+        if(length != 15) return length;
+        do {
+            byte = spiFlash_stream_read(stream); // 0 once the stream is over
+            length += byte;
+        } while(byte == 255);
+        return length;
+    }
+
+    /**
+    * Decompress an LZ4 block while it is read from the flash. Bytes keep arriving from the SPI
+    * while the matches are copied, the literals are stored as they are popped.
+    * Returns 1 if the block decoded to exactly length bytes, 0 if it is corrupted.
+    *
+    * @param stream The compressed stream, positioned at the start of the block
+    * @param memoryAddress The RAM address to write the data
+    * @param length The size of the data once decompressed
+    * @param storedLength The size of the compressed block
+    */
+    static u32 bootImage_lz4Stream(SpiFlash_Stream *stream, u32 memoryAddress, u32 length, u32 storedLength){
+        u8 *out = (u8 *) memoryAddress;
+        u8 *end = out + length;
+        u32 blockEnd = stream->received + storedLength;
+        while(stream->received < blockEnd){
+            u32 token = spiFlash_stream_read(stream);
+            u32 literals = bootImage_lz4Length(stream, token >> 4);
+            if(literals > (u32)(end - out)) return 0;
+            while(literals--) *out++ = spiFlash_stream_read(stream);
+            if(stream->received >= blockEnd) break; // The last sequence has no match
+
+            u32 offset = spiFlash_stream_read(stream);
+            offset |= spiFlash_stream_read(stream) << 8;
+            u32 match = bootImage_lz4Length(stream, token & 0xF) + 4;
+            if(offset == 0 || offset > (u32)(out - (u8 *) memoryAddress)) return 0;
+            if(match > (u32)(end - out)) return 0;
+            u8 *from = out - offset;
+            while(match--) *out++ = *from++;
+        }
+        return out == end && stream->received == blockEnd;
+    }
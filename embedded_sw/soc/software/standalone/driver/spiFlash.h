@@ -27,10 +27,19 @@
 #include "spi.h"
 #include "gpio.h"
 #include "io.h"
+#include "dmasg.h"
+#include "crc32.h"
 
 #define MX25_QUAD_ENABLE_BIT        0x40
 #define MX25_WRITE_ENABLE_LATCH_BIT 0x02
 
+// Most read commands spiFlash_read_() keeps in flight, must not exceed the SPI response FIFO depth
+#ifndef SPI_FLASH_READ_PIPELINE
+#define SPI_FLASH_READ_PIPELINE     64
+#endif
+
+#define SPI_FLASH_DMA_BYTES_PER_BURST 64
+
     /**
     * Set SPI Flash device Chip Select with GPIO port
     * 
@@ -251,6 +260,126 @@
     }
 #endif
  
+    /**
+    * Read the data of a read command already sent and copy it to memoryAddress
+    * The command FIFO is refilled and the response FIFO drained from a single SPI_BUFFER read,
+    * so the SPI keeps clocking data while the CPU stores the previous bytes. Up to
+    * SPI_FLASH_READ_PIPELINE reads are in flight, the bytes are stored to RAM a word at a time.
+    *
+    * Define SPI_FLASH_READ_LARGE when the SPI controller is generated with the large read
+    * access, so a single SPI_READ_LARGE read pops 4 response bytes, the first one in the low byte.
+    *
+    * @param spi SPI port base address
+    * @param memoryAddress The RAM address to write the data
+    * @param size The size of data to copy
+    */
+    static void spiFlash_read_(u32 spi, u32 memoryAddress, u32 size){
+        u32 issued = 0;
+        u32 received = 0;
+        u32 word = 0;
+        u8 *ram = (u8 *) memoryAddress;
+        // Bytes up to the first word boundary
+        while(received < size && ((u32)ram & 3)){
+            *ram++ = spi_read(spi);
+            received++;
+        }
+        issued = received;
+        u32 first = received;
+        u32 *words = (u32 *) ram;
+        u32 end = received + ((size - received) & ~3);
+        while(received < end){
+            u32 buffer = read_u32(spi + SPI_BUFFER);
+            u32 space = buffer & 0xFFFF;
+            u32 occupancy = buffer >> 16;
+            u32 issue = SPI_FLASH_READ_PIPELINE - (issued - received);
+            if(issue > space) issue = space;
+            if(issue > end - issued) issue = end - issued;
+            issued += issue;
+            while(issue--) write_u32(SPI_CMD_READ, spi + SPI_DATA);
+#ifdef SPI_FLASH_READ_LARGE
+            for(;occupancy >= 4;occupancy -= 4){
+                *words++ = read_u32(spi + SPI_READ_LARGE);
+                received += 4;
+            }
+#else
+            while(occupancy--){
+                word = (word >> 8) | (read_u32(spi + SPI_DATA) << 24);
+                received++;
+                if(((received - first) & 3) == 0) *words++ = word;
+            }
+#endif
+        }
+        // Last bytes after the last word
+        ram = (u8 *) words;
+        while(received < size){
+            *ram++ = spi_read(spi);
+            received++;
+        }
+    }
+
+    /**
+    * spiFlash_read_() which also computes the CRC32 of the data while it is read, so checking
+    * the data doesn't need a second pass over the memory. The table lookup of each byte
+    * runs while the SPI clocks the next ones.
+    *
+    * @param spi SPI port base address
+    * @param memoryAddress The RAM address to write the data
+    * @param size The size of data to copy
+    * @param crc The CRC32 to update, CRC32_INIT or the result of crc32_update()
+    */
+    static u32 spiFlash_read_crc_(u32 spi, u32 memoryAddress, u32 size, u32 crc){
+        u32 issued = 0;
+        u32 received = 0;
+        u32 word = 0;
+        u8 *ram = (u8 *) memoryAddress;
+        // Bytes up to the first word boundary
+        while(received < size && ((u32)ram & 3)){
+            u8 byte = spi_read(spi);
+            crc = crc32_table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+            *ram++ = byte;
+            received++;
+        }
+        issued = received;
+        u32 first = received;
+        u32 *words = (u32 *) ram;
+        u32 end = received + ((size - received) & ~3);
+        while(received < end){
+            u32 buffer = read_u32(spi + SPI_BUFFER);
+            u32 space = buffer & 0xFFFF;
+            u32 occupancy = buffer >> 16;
+            u32 issue = SPI_FLASH_READ_PIPELINE - (issued - received);
+            if(issue > space) issue = space;
+            if(issue > end - issued) issue = end - issued;
+            issued += issue;
+            while(issue--) write_u32(SPI_CMD_READ, spi + SPI_DATA);
+#ifdef SPI_FLASH_READ_LARGE
+            for(;occupancy >= 4;occupancy -= 4){
+                word = read_u32(spi + SPI_READ_LARGE);
+                crc = crc32_update(crc, &word, 4); // First byte in the low byte
+                *words++ = word;
+                received += 4;
+            }
+#else
+            while(occupancy--){
+                u32 byte = read_u32(spi + SPI_DATA) & 0xFF;
+                crc = crc32_table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+                word = (word >> 8) | (byte << 24);
+                received++;
+                if(((received - first) & 3) == 0) *words++ = word;
+            }
+#endif
+        }
+        // Last bytes after the last word
+        ram = (u8 *) words;
+        while(received < size){
+            u8 byte = spi_read(spi);
+            crc = crc32_table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+            *ram++ = byte;
+            received++;
+        }
+        return crc;
+    }
+
     /**
     * Read data from FlashAddress and copy to memoryAddress of specific size
     * With single data line 
@@ -266,11 +395,7 @@
         spi_write(spi, flashAddress >>  8);
         spi_write(spi, flashAddress >>  0);
         spi_write(spi, 0);
-        uint8_t *ram = (uint8_t *) memoryAddress;
-        for(u32 idx = 0;idx < size;idx++){
-            u8 value = spi_read(spi);
-            *ram++ = value;
-        }
+        spiFlash_read_(spi, memoryAddress, size);
     }
     
     /**
@@ -292,11 +417,7 @@
         spi_write(spi, 0);
         spi_waitXferBusy(spi); // Make sure all spi data transferred before switching mode
         spiFlash_init_mode_(spi, 0x01); // change mode to dual data mode
-        uint8_t *ram = (uint8_t *) memoryAddress;
-        for(u32 idx = 0;idx < size;idx++){
-            u8 value = spi_read(spi);
-            *ram++ = value;
-        }
+        spiFlash_read_(spi, memoryAddress, size);
         spiFlash_init_mode_(spi, 0x00); // change mode back to single data mode
     }
 
@@ -321,14 +442,208 @@
         spi_write(spi, 0);
         spi_waitXferBusy(spi); // Make sure all spi data transferred before switching mode
         spiFlash_init_mode_(spi, 0x02); // change mode to quad data mode
-        uint8_t *ram = (uint8_t *) memoryAddress;
-        for(u32 idx = 0;idx < size;idx++){
-            u8 value = spi_read(spi);
-            *ram++ = value;
-        }
+        spiFlash_read_(spi, memoryAddress, size);
         spiFlash_init_mode_(spi, 0x00); // change mode back to single data mode
     }
 
+    /**
+    * Read data from FlashAddress and copy it to memoryAddress with a dmasg channel
+    * The channel moves the bytes of the SPI RX stream to memory, the CPU only feeds the read
+    * commands to the SPI command FIFO. Returns once every command is executed, the caller then
+    * waits for dmasg_busy() to clear before using the data.
+    *
+    * @param spi SPI port base address
+    * @param dma dmasg base address
+    * @param channel dmasg channel connected to the SPI RX stream
+    * @param port input port of the channel connected to the SPI RX stream
+    * @param mode 0 for single, 1 for dual and 2 for quad data lines
+    * @param flashAddress The flash address to read the data
+    * @param memoryAddress The RAM address to write the data
+    * @param size The size of data to copy
+    */
+    static void spiFlash_dma_f2m_(u32 spi, u32 dma, u32 channel, u32 port, u32 mode, u32 flashAddress, u32 memoryAddress, u32 size){
+        static const u8 commands[] = {0x0B, 0x3B, 0x6B};
+        dmasg_input_stream(dma, channel, port, 0, 0);
+        dmasg_output_memory(dma, channel, memoryAddress, SPI_FLASH_DMA_BYTES_PER_BURST);
+        dmasg_direct_start(dma, channel, size, 0);
+
+        spi_write(spi, commands[mode]);
+        spi_write(spi, flashAddress >> 16);
+        spi_write(spi, flashAddress >>  8);
+        spi_write(spi, flashAddress >>  0);
+        spi_write(spi, 0);
+        if(mode){
+            spi_waitXferBusy(spi); // Make sure all spi data transferred before switching mode
+            spiFlash_init_mode_(spi, mode);
+        }
+        while(size){
+            u32 issue = spi_cmdAvailability(spi);
+            if(issue > size) issue = size;
+            size -= issue;
+            while(issue--) write_u32(SPI_CMD_READ, spi + SPI_DATA);
+        }
+        spi_waitXferBusy(spi);
+        if(mode) spiFlash_init_mode_(spi, 0x00); // change mode back to single data mode
+    }
+
+    /**
+    * Read data from FlashAddress and copy to memoryAddress of specific size with Chip Select and a dmasg channel.
+    * The DMA writes behind the data cache, invalidate it once the channel is done before the CPU reads the data.
+    *
+    * @param spi SPI port base address
+    * @param cs 32-bit bitwise chip select setting
+    * @param dma dmasg base address
+    * @param channel dmasg channel connected to the SPI RX stream
+    * @param port input port of the channel connected to the SPI RX stream
+    * @param mode 0 for single, 1 for dual and 2 for quad data lines
+    * @param flashAddress The flash address to read the data
+    * @param memoryAddress The RAM address to write the data
+    * @param size The size of data to copy
+    */
+    static void spiFlash_f2m_dma(u32 spi, u32 cs, u32 dma, u32 channel, u32 port, u32 mode, u32 flashAddress, u32 memoryAddress, u32 size){
+#if defined(DEFAULT_ADDRESS_BYTE) || defined(MX25_FLASH)
+        if(mode == 2) spiFlash_enable_quad_access(spi,cs);
+#endif
+        spiFlash_select(spi,cs);
+        spiFlash_dma_f2m_(spi, dma, channel, port, mode, flashAddress, memoryAddress, size);
+        spiFlash_diselect(spi,cs);
+    }
+
+    /**
+    * Flash read consumed one byte at a time by the CPU, for data which need processing before
+    * landing in memory (decompression). Up to SPI_FLASH_READ_PIPELINE read commands are kept
+    * in flight, so the SPI keeps reading ahead while the CPU works on the previous bytes.
+    */
+    typedef struct {
+        u32 spi;
+        u32 cs;
+        u32 mode;
+        u32 size;     // Bytes to read
+        u32 issued;   // Read commands sent
+        u32 received; // Bytes popped from the response FIFO
+        u32 crc;      // CRC32 of the bytes popped, not finalized, see crc32.h
+    } SpiFlash_Stream;
+
+    /**
+    * Queue read commands, up to SPI_FLASH_READ_PIPELINE ahead of the bytes already popped
+    *
+    * @param stream The stream to feed
+    */
+    static void spiFlash_stream_fill(SpiFlash_Stream *stream){
+        u32 issue = SPI_FLASH_READ_PIPELINE - (stream->issued - stream->received);
+        u32 space = spi_cmdAvailability(stream->spi);
+        if(issue > space) issue = space;
+        if(issue > stream->size - stream->issued) issue = stream->size - stream->issued;
+        stream->issued += issue;
+        while(issue--) write_u32(SPI_CMD_READ, stream->spi + SPI_DATA);
+    }
+
+    /**
+    * Select the flash and start a read of size bytes at flashAddress
+    *
+    * @param stream The stream to initialize
+    * @param spi SPI port base address
+    * @param cs 32-bit bitwise chip select setting
+    * @param mode 0 for single, 1 for dual and 2 for quad data lines
+    * @param flashAddress The flash address to read the data
+    * @param size The number of bytes which will be read
+    */
+    static void spiFlash_stream_start(SpiFlash_Stream *stream, u32 spi, u32 cs, u32 mode, u32 flashAddress, u32 size){
+        static const u8 commands[] = {0x0B, 0x3B, 0x6B};
+        stream->spi = spi;
+        stream->cs = cs;
+        stream->mode = mode;
+        stream->size = size;
+        stream->issued = 0;
+        stream->received = 0;
+        stream->crc = CRC32_INIT;
+#if defined(DEFAULT_ADDRESS_BYTE) || defined(MX25_FLASH)
+        if(mode == 2) spiFlash_enable_quad_access(spi,cs);
+#endif
+        spiFlash_select(spi,cs);
+        spi_write(spi, commands[mode]);
+        spi_write(spi, flashAddress >> 16);
+        spi_write(spi, flashAddress >>  8);
+        spi_write(spi, flashAddress >>  0);
+        spi_write(spi, 0);
+        if(mode){
+            spi_waitXferBusy(spi); // Make sure all spi data transferred before switching mode
+            spiFlash_init_mode_(spi, mode);
+        }
+        spiFlash_stream_fill(stream);
+    }
+
+    /**
+    * Pop the next byte of the stream and add it to the stream CRC32,
+    * returns 0 once the size given to spiFlash_stream_start() is read
+    *
+    * @param stream The stream to read
+    */
+    static u8 spiFlash_stream_read(SpiFlash_Stream *stream){
+        u32 spi = stream->spi;
+        if(stream->received == stream->size) return 0;
+        if(stream->issued - stream->received < SPI_FLASH_READ_PIPELINE/2){
+            do {
+                spiFlash_stream_fill(stream);
+            } while(stream->issued == stream->received);
+        }
+        stream->received++;
+        while(spi_rspOccupancy(spi) == 0);
+        u8 byte = read_u32(spi + SPI_DATA);
+        stream->crc = crc32_table[(stream->crc ^ byte) & 0xFF] ^ (stream->crc >> 8);
+        return byte;
+    }
+
+    /**
+    * Drop the bytes still in flight, restore the single data line mode and release the flash
+    *
+    * @param stream The stream to close
+    */
+    static void spiFlash_stream_stop(SpiFlash_Stream *stream){
+        u32 spi = stream->spi;
+        while(stream->received != stream->issued){
+            while(spi_rspOccupancy(spi) == 0);
+            read_u32(spi + SPI_DATA);
+            stream->received++;
+        }
+        spi_waitXferBusy(spi);
+        if(stream->mode) spiFlash_init_mode_(spi, 0x00); // change mode back to single data mode
+        spiFlash_diselect(spi, stream->cs);
+    }
+
+    /**
+    * Read data from FlashAddress and copy to memoryAddress of specific size with Chip Select,
+    * returns the CRC32 of the data updated from crc, see spiFlash_read_crc_()
+    *
+    * @param spi SPI port base address
+    * @param cs 32-bit bitwise chip select setting
+    * @param mode 0 for single, 1 for dual and 2 for quad data lines
+    * @param flashAddress The flash address to read the data
+    * @param memoryAddress The RAM address to write the data
+    * @param size The size of data to copy
+    * @param crc The CRC32 to update, CRC32_INIT or the result of crc32_update()
+    */
+    static u32 spiFlash_f2m_crc(u32 spi, u32 cs, u32 mode, u32 flashAddress, u32 memoryAddress, u32 size, u32 crc){
+        static const u8 commands[] = {0x0B, 0x3B, 0x6B};
+#if defined(DEFAULT_ADDRESS_BYTE) || defined(MX25_FLASH)
+        if(mode == 2) spiFlash_enable_quad_access(spi,cs);
+#endif
+        spiFlash_select(spi,cs);
+        spi_write(spi, commands[mode]);
+        spi_write(spi, flashAddress >> 16);
+        spi_write(spi, flashAddress >>  8);
+        spi_write(spi, flashAddress >>  0);
+        spi_write(spi, 0);
+        if(mode){
+            spi_waitXferBusy(spi); // Make sure all spi data transferred before switching mode
+            spiFlash_init_mode_(spi, mode);
+        }
+        crc = spiFlash_read_crc_(spi, memoryAddress, size, crc);
+        if(mode) spiFlash_init_mode_(spi, 0x00); // change mode back to single data mode
+        spiFlash_diselect(spi,cs);
+        return crc;
+    }
+
     /**
     * Read data from FlashAddress and copy to memoryAddress of specific size with GPIO Chip Select
     * 
@@ -0,0 +1,329 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include "type.h"
+#include "io.h"
+#include "uart.h"
+
+// Binary telemetry channel sharing the UART with the text console.
+// Each record is sent as a COBS encoded frame between two 0x00 delimiters:
+//     0x00, COBS(type, sequence, record bytes, CRC-16 low, CRC-16 high), 0x00
+// The text console never sends 0x00 and COBS removes it from the frame content, so the
+// host (tool/telemetryDemux.py) can split text from frames without any escaping of the text.
+// The CRC is CRC-16/CCITT-FALSE over type, sequence and record.
+// Records are the little endian structures below, sent as they are in memory.
+//
+// The host sends command frames with the same encoding. telemetry_interrupt() drains the
+// UART RX FIFO from the RX not empty interrupt (uart_RX_NotemptyInterruptEna), decodes the
+// frames in place and queues them. The application gets them with telemetry_command() and
+// releases them with telemetry_commandDone(), the bytes outside of frames go to the text callback.
+// Tokenized printf frames (print_token.h) can contain 0x00 and must not share the UART with it.
+
+#define TELEMETRY_MAX_RECORD    240
+// Number of received command frames waiting for the application, must be a power of two
+#ifndef TELEMETRY_RX_SLOTS
+#define TELEMETRY_RX_SLOTS      2
+#endif
+
+#define TELEMETRY_FRAME_SIZE    (2 + TELEMETRY_MAX_RECORD + 2)
+
+// Record types, target to host
+#define TELEMETRY_COUNTER       0x01
+#define TELEMETRY_HISTOGRAM     0x02
+#define TELEMETRY_FRAME_TIMING  0x03
+#define TELEMETRY_ACK           0x04
+// Record types, host to target
+#define TELEMETRY_COMMAND       0x80
+
+#define TELEMETRY_HISTOGRAM_BINS 16
+
+    typedef struct {
+        u16 id;
+        u16 reserved;
+        u32 value;
+    } Telemetry_Counter;
+
+    typedef struct {
+        u16 id;
+        u16 binCount;
+        u32 binWidth;
+        u32 bins[TELEMETRY_HISTOGRAM_BINS];
+    } Telemetry_Histogram;
+
+    typedef struct {
+        u32 frame;
+        u32 renderTicks;
+        u32 transmitTicks;
+        u32 bytes;
+    } Telemetry_FrameTiming;
+
+    typedef struct {
+        u8 command;
+        u8 reserved[3];
+        u32 argument;
+    } Telemetry_Command;
+
+    typedef struct {
+        u8 command;
+        u8 reserved[3];
+        u32 status;
+    } Telemetry_Ack;
+
+    typedef void (*Telemetry_Write)(void *arg, const char *p, u32 len);
+    typedef void (*Telemetry_Text)(void *arg, char c);
+
+    typedef struct {
+        u32 length;
+        u8 data[TELEMETRY_FRAME_SIZE];
+    } Telemetry_RxFrame;
+
+    typedef struct {
+        u32 reg;
+        Telemetry_Write write;
+        void *writeArg;
+        Telemetry_Text text;
+        void *textArg;
+        u8 txSequence;
+
+        // Receiver, only accessed by the interrupt routine, except head and tail
+        u32 rxInFrame;
+        u32 rxLength;
+        u8 rxEncoded[TELEMETRY_FRAME_SIZE + 1];
+        volatile u32 rxHead;
+        volatile u32 rxTail;
+        Telemetry_RxFrame rxFrames[TELEMETRY_RX_SLOTS];
+        u32 rxErrors;
+        u32 rxDropped;
+    } Telemetry;
+
+    /**
+    * Initialize the telemetry channel
+    *
+    * @param t channel instance
+    * @param reg UART base address
+    * @param write output used for the frames, for eg uartTx_sink, null to write the UART directly
+    * @param writeArg user argument given to write
+    * @param text called from the interrupt with each received byte which isn't part of a frame, can be null
+    * @param textArg user argument given to text
+    */
+    static void telemetry_init(Telemetry *t, u32 reg, Telemetry_Write write, void *writeArg, Telemetry_Text text, void *textArg){
+        t->reg = reg;
+        t->write = write;
+        t->writeArg = writeArg;
+        t->text = text;
+        t->textArg = textArg;
+        t->txSequence = 0;
+        t->rxInFrame = 0;
+        t->rxLength = 0;
+        t->rxHead = 0;
+        t->rxTail = 0;
+        t->rxErrors = 0;
+        t->rxDropped = 0;
+    }
+
+    static u16 telemetry_crc16(const u8 *data, u32 len){
+        static const u16 nibbles[16] = {
+            0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+            0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+        };
+        u16 crc = 0xFFFF;
+        while(len--){
+            u8 byte = *data++;
+            crc = (crc << 4) ^ nibbles[(crc >> 12) ^ (byte >> 4)];
+            crc = (crc << 4) ^ nibbles[(crc >> 12) ^ (byte & 0xF)];
+        }
+        return crc;
+    }
+
+    // COBS encode len bytes (len < 254) into out, returns the encoded size (len + 1)
+    static u32 telemetry_cobsEncode(const u8 *in, u32 len, u8 *out){
+        u8 *code = out++;
+        u8 run = 1;
+        for(u32 i = 0;i < len;i++){
+            if(in[i]){
+                *out++ = in[i];
+                run++;
+            } else {
+                *code = run;
+                code = out++;
+                run = 1;
+            }
+        }
+        *code = run;
+        return len + 1;
+    }
+
+    // COBS decode in place, returns the decoded size or -1 if the encoding is broken
+    static s32 telemetry_cobsDecode(const u8 *in, u32 len, u8 *out){
+        u32 o = 0;
+        u32 i = 0;
+        while(i < len){
+            u8 code = in[i++];
+            if(!code || i + code - 1 > len) return -1;
+            for(u32 j = 1;j < code;j++) out[o++] = in[i++];
+            if(code != 0xFF && i != len) out[o++] = 0;
+        }
+        return o;
+    }
+
+    /**
+    * Send a record, record is sent as it is in memory
+    *
+    * @param t channel instance
+    * @param type record type, TELEMETRY_COUNTER, ...
+    * @param record record address
+    * @param len record size in bytes, up to TELEMETRY_MAX_RECORD
+    */
+    static void telemetry_send(Telemetry *t, u32 type, const void *record, u32 len){
+        u8 frame[TELEMETRY_FRAME_SIZE];
+        u8 encoded[TELEMETRY_FRAME_SIZE + 3];
+        const u8 *bytes = (const u8 *) record;
+
+        if(len > TELEMETRY_MAX_RECORD) len = TELEMETRY_MAX_RECORD;
+        frame[0] = type;
+        frame[1] = t->txSequence++;
+        for(u32 i = 0;i < len;i++) frame[2 + i] = bytes[i];
+        u16 crc = telemetry_crc16(frame, 2 + len);
+        frame[2 + len] = crc;
+        frame[3 + len] = crc >> 8;
+
+        encoded[0] = 0;
+        u32 size = telemetry_cobsEncode(frame, 4 + len, encoded + 1);
+        encoded[1 + size] = 0;
+        if(t->write){
+            t->write(t->writeArg, (const char *) encoded, size + 2);
+        } else {
+            uart_writeBuf(t->reg, (const char *) encoded, size + 2);
+        }
+    }
+
+    static void telemetry_counter(Telemetry *t, u32 id, u32 value){
+        Telemetry_Counter record = {id, 0, value};
+        telemetry_send(t, TELEMETRY_COUNTER, &record, sizeof(record));
+    }
+
+    // Only the first binCount bins are sent
+    static void telemetry_histogram(Telemetry *t, Telemetry_Histogram *histogram){
+        u32 binCount = histogram->binCount < TELEMETRY_HISTOGRAM_BINS ? histogram->binCount : TELEMETRY_HISTOGRAM_BINS;
+        telemetry_send(t, TELEMETRY_HISTOGRAM, histogram, 8 + 4*binCount);
+    }
+
+    static void telemetry_frameTiming(Telemetry *t, Telemetry_FrameTiming *timing){
+        telemetry_send(t, TELEMETRY_FRAME_TIMING, timing, sizeof(Telemetry_FrameTiming));
+    }
+
+    static void telemetry_ack(Telemetry *t, u32 command, u32 status){
+        Telemetry_Ack record = {command, {0, 0, 0}, status};
+        telemetry_send(t, TELEMETRY_ACK, &record, sizeof(record));
+    }
+
+    static void telemetry_rxFrameEnd(Telemetry *t){
+        if(t->rxHead - t->rxTail == TELEMETRY_RX_SLOTS){
+            t->rxDropped++;
+            return;
+        }
+        Telemetry_RxFrame *frame = &t->rxFrames[t->rxHead & (TELEMETRY_RX_SLOTS-1)];
+        s32 length = telemetry_cobsDecode(t->rxEncoded, t->rxLength, frame->data);
+        if(length < 4 || telemetry_crc16(frame->data, length - 2) != (frame->data[length-2] | (frame->data[length-1] << 8))){
+            t->rxErrors++;
+            return;
+        }
+        frame->length = length - 2;
+        asm("fence w,w");
+        t->rxHead++;
+    }
+
+    // Feed one received byte to the frame parser
+    static void telemetry_rxByte(Telemetry *t, u8 byte){
+        if(byte == 0){
+            if(t->rxInFrame && t->rxLength){
+                telemetry_rxFrameEnd(t);
+                t->rxInFrame = 0;
+            } else {
+                // Opening delimiter, or two delimiters in a row to resynchronise
+                t->rxInFrame = 1;
+            }
+            t->rxLength = 0;
+        } else if(t->rxInFrame){
+            if(t->rxLength == sizeof(t->rxEncoded)){
+                // Too long for a frame, the opening delimiter was lost
+                t->rxErrors++;
+                t->rxInFrame = 0;
+                t->rxLength = 0;
+                return;
+            }
+            t->rxEncoded[t->rxLength++] = byte;
+        } else if(t->text){
+            t->text(t->textArg, byte);
+        }
+    }
+
+    /**
+    * Interrupt routine, to be called when the UART interrupt is claimed.
+    * Drains the whole RX FIFO into the frame parser.
+    */
+    static void telemetry_interrupt(Telemetry *t){
+        u32 occupancy;
+        while((occupancy = uart_readOccupancy(t->reg))){
+            while(occupancy--) telemetry_rxByte(t, read_u32(t->reg + UART_DATA));
+        }
+    }
+
+    /**
+    * Get the oldest received command frame without copying it
+    *
+    * @param t channel instance
+    * @param payload set to the frame content after the sequence number
+    * @param length set to the payload size in bytes
+    *
+    * @return frame type, 0 if there is no frame, the frame stays valid until telemetry_commandDone()
+    */
+    static u32 telemetry_command(Telemetry *t, const u8 **payload, u32 *length){
+        if(t->rxTail == t->rxHead) return 0;
+        asm("fence r,r");
+        Telemetry_RxFrame *frame = &t->rxFrames[t->rxTail & (TELEMETRY_RX_SLOTS-1)];
+        *payload = frame->data + 2;
+        *length = frame->length - 2;
+        return frame->data[0];
+    }
+
+    static void telemetry_commandDone(Telemetry *t){
+        asm("fence rw,w");
+        t->rxTail++;
+    }
@@ -30,6 +30,18 @@
 #define UART_STATUS         0x04
 #define UART_CLOCK_DIVIDER  0x08
 #define UART_FRAME_CONFIG   0x0C
+#define UART_STATUS_TX_INT_ENABLE   BIT_0
+#define UART_STATUS_RX_INT_ENABLE   BIT_1
+#define UART_STATUS_TX_INT_PENDING  BIT_8
+#define UART_STATUS_RX_INT_PENDING  BIT_9
+
+#ifndef UART_TX_FIFO_DEPTH
+#ifdef SYSTEM_UART_0_IO_PARAMETER_TX_FIFO_DEPTH
+#define UART_TX_FIFO_DEPTH  SYSTEM_UART_0_IO_PARAMETER_TX_FIFO_DEPTH
+#else
+#define UART_TX_FIFO_DEPTH  128
+#endif
+#endif
 
 enum UartDataLength {BITS_8 = 8};
 enum UartParity {NONE = 0,EVEN = 1,ODD = 2};
@@ -54,8 +66,32 @@ enum UartStop {ONE = 0,TWO = 1};
         write_u32(data, reg + UART_DATA);
     }
     
+    // One status read per burst instead of one per byte
     static void uart_writeStr(u32 reg, const char* str){
-        while(*str) uart_write(reg, *str++);
+        while(*str){
+            u32 availability = uart_writeAvailability(reg);
+            while(availability && *str){
+                write_u32((u8)*str++, reg + UART_DATA);
+                availability--;
+            }
+        }
+    }
+
+    /**
+    * Write len bytes, reading the TX FIFO availability once and then
+    * pushing that many bytes back to back.
+    *
+    * @param reg UART base address
+    * @param buf data to send
+    * @param len number of bytes to send
+    */
+    static void uart_writeBuf(u32 reg, const char* buf, u32 len){
+        while(len){
+            u32 availability = uart_writeAvailability(reg);
+            if(availability > len) availability = len;
+            len -= availability;
+            while(availability--) write_u32((u8)*buf++, reg + UART_DATA);
+        }
     }
     
     static char uart_read(u32 reg){
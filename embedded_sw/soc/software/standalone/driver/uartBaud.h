@@ -0,0 +1,194 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include "type.h"
+#include "io.h"
+#include "uart.h"
+#include "clint.h"
+
+// Host negotiated UART baudrate.
+// The firmware proposes a list of baudrates, switches only once the host picked one,
+// then checks the link at the new rate and falls back to the initial rate on timeout.
+//
+// Protocol, one line per message :
+//   target -> host  "#BAUD?<rate>,<rate>,...\r\n"   proposal, only the rates the divider can reach within UART_BAUD_MAX_ERROR
+//   host -> target  "#BAUD!<rate>\n"                 accepted rate, 0 to stay at the current rate
+//   both switch to the accepted rate
+//   target -> host  "#SYNC\r\n"                      repeated until acknowledged or timeout
+//   host -> target  "#ACK\n"
+// See tool/uartBaud.py for the host side.
+
+// Maximum baudrate error accepted, in per mille
+#ifndef UART_BAUD_MAX_ERROR
+#define UART_BAUD_MAX_ERROR 20
+#endif
+
+#ifndef UART_BAUD_SAMPLE_PER_BIT
+#ifdef SYSTEM_UART_0_IO_PARAMETER_UART_CTRL_CONFIG_RX_SAMPLE_PER_BIT
+#define UART_BAUD_SAMPLE_PER_BIT SYSTEM_UART_0_IO_PARAMETER_UART_CTRL_CONFIG_RX_SAMPLE_PER_BIT
+#else
+#define UART_BAUD_SAMPLE_PER_BIT 8
+#endif
+#endif
+
+#define UART_BAUD_DIVIDER_MAX ((1 << 20) - 1)
+#define UART_BAUD_LINE_SIZE 64
+
+    // Closest clock divider for the given baudrate
+    static u32 uartBaud_divider(u32 hz, u32 baudrate){
+        u32 bitHz = baudrate * UART_BAUD_SAMPLE_PER_BIT;
+        u32 divider = (hz + bitHz/2) / bitHz;
+        if(divider == 0) divider = 1;
+        if(divider > UART_BAUD_DIVIDER_MAX + 1) divider = UART_BAUD_DIVIDER_MAX + 1;
+        return divider - 1;
+    }
+
+    // Baudrate really produced by a clock divider
+    static u32 uartBaud_actual(u32 hz, u32 divider){
+        return hz / ((divider + 1) * UART_BAUD_SAMPLE_PER_BIT);
+    }
+
+    // Error between the requested and the real baudrate, in per mille
+    static u32 uartBaud_error(u32 hz, u32 baudrate){
+        u32 actual = uartBaud_actual(hz, uartBaud_divider(hz, baudrate));
+        u32 diff = actual > baudrate ? actual - baudrate : baudrate - actual;
+        return (u32)(((u64)diff * 1000) / baudrate);
+    }
+
+    // Apply 8N1 at the given baudrate, the TX FIFO is drained first to not corrupt pending bytes
+    static void uartBaud_apply(u32 reg, u32 hz, u32 baudrate){
+        Uart_Config config;
+        while(uart_writeAvailability(reg) != UART_TX_FIFO_DEPTH);
+        config.dataLength = BITS_8;
+        config.parity = NONE;
+        config.stop = ONE;
+        config.clockDivider = uartBaud_divider(hz, baudrate);
+        uart_applyConfig(reg, &config);
+    }
+
+    static void uartBaud_writeDec(u32 reg, u32 value){
+        char buffer[10];
+        u32 len = 0;
+        do {
+            buffer[sizeof(buffer) - ++len] = '0' + value % 10;
+            value /= 10;
+        } while(value);
+        uart_writeBuf(reg, buffer + sizeof(buffer) - len, len);
+    }
+
+    static u32 uartBaud_parseDec(const char *str){
+        u32 value = 0;
+        while(*str >= '0' && *str <= '9') value = value*10 + *str++ - '0';
+        return value;
+    }
+
+    /**
+    * Read one line, without the line termination
+    *
+    * @return line length, -1 on timeout
+    */
+    static s32 uartBaud_readLine(u32 reg, char *line, u32 size, u32 clint, u32 hz, u32 timeoutUs){
+        u32 deadline = clint_getTimeLow(clint) + timeoutUs*(hz/1000000);
+        u32 len = 0;
+        while((s32)(deadline - clint_getTimeLow(clint)) > 0){
+            if(!uart_readOccupancy(reg)) continue;
+            char c = read_u32(reg + UART_DATA);
+            if(c == '\r') continue;
+            if(c == '\n'){
+                line[len] = 0;
+                return len;
+            }
+            if(len < size - 1) line[len++] = c;
+        }
+        return -1;
+    }
+
+    static u32 uartBaud_startsWith(const char *str, const char *prefix){
+        while(*prefix) if(*str++ != *prefix++) return 0;
+        return 1;
+    }
+
+    /**
+    * Propose higher baudrates to the host and switch to the one it accepts.
+    *
+    * @param reg UART base address
+    * @param hz UART clock frequency
+    * @param clint CLINT base address used for the timeouts
+    * @param current baudrate in use, restored on failure
+    * @param rates proposed baudrates
+    * @param count number of proposed baudrates
+    * @param timeoutUs time given to the host for each step
+    *
+    * @return the baudrate in use when returning
+    */
+    static u32 uartBaud_negotiate(u32 reg, u32 hz, u32 clint, u32 current, const u32 *rates, u32 count, u32 timeoutUs){
+        char line[UART_BAUD_LINE_SIZE];
+        u32 first = 1;
+
+        uart_writeStr(reg, "\r\n#BAUD?");
+        for(u32 i = 0;i < count;i++){
+            if(uartBaud_error(hz, rates[i]) > UART_BAUD_MAX_ERROR) continue;
+            if(!first) uart_write(reg, ',');
+            uartBaud_writeDec(reg, rates[i]);
+            first = 0;
+        }
+        uart_writeStr(reg, "\r\n");
+
+        if(uartBaud_readLine(reg, line, sizeof(line), clint, hz, timeoutUs) < 0) return current;
+        if(!uartBaud_startsWith(line, "#BAUD!")) return current;
+        u32 accepted = uartBaud_parseDec(line + 6);
+        u32 valid = 0;
+        for(u32 i = 0;i < count;i++){
+            if(rates[i] == accepted && uartBaud_error(hz, accepted) <= UART_BAUD_MAX_ERROR) valid = 1;
+        }
+        if(!valid) return current;
+
+        uartBaud_apply(reg, hz, accepted);
+        while(uart_readOccupancy(reg)) read_u32(reg + UART_DATA);
+        for(u32 retry = 0;retry < 8;retry++){
+            uart_writeStr(reg, "#SYNC\r\n");
+            if(uartBaud_readLine(reg, line, sizeof(line), clint, hz, timeoutUs/8) >= 0 && uartBaud_startsWith(line, "#ACK")){
+                return accepted;
+            }
+        }
+
+        uartBaud_apply(reg, hz, current);
+        return current;
+    }
+
@@ -0,0 +1,225 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include "type.h"
+#include "io.h"
+#include "dmasg.h"
+#include "uartTx.h"
+
+// DMA backed bulk UART transmit.
+// A dmasg channel streams whole buffers (or linked lists of fragments) from memory
+// to the UART TX stream port without any CPU copy. The channel completion interrupt
+// hands the buffer back to the application through the done callback.
+// When the SoC has no DMA channel wired to the UART (dma == 0), the data goes through
+// the interrupt driven ring buffer of uartTx.h instead and the buffer is handed back
+// as soon as it has been copied.
+
+#define UART_DMA_BYTES_PER_BURST 64
+
+    typedef void (*UartDma_Done)(const char *buf, void *arg);
+
+    typedef struct {
+        u32 dma;
+        u32 channel;
+        u32 port;
+        UartTx *fallback;
+        UartDma_Done done;
+        void *doneArg;
+        const char * volatile buffer;
+        volatile u32 busy;
+        // Always completed descriptor used to terminate the linked lists
+        struct dmasg_descriptor stop __attribute__ ((aligned (64)));
+    } UartDma;
+
+    /**
+    * Initialize the UART DMA transmitter
+    *
+    * @param d transmitter instance
+    * @param dma dmasg base address, 0 if the SoC has no DMA channel connected to the UART
+    * @param channel dmasg channel connected to the UART TX stream
+    * @param port output port of the channel connected to the UART TX stream
+    * @param fallback interrupt driven ring buffer used when dma is 0
+    * @param done called from the interrupt when a buffer can be reused, can be null
+    * @param doneArg user argument given to done
+    */
+    static void uartDma_init(UartDma *d, u32 dma, u32 channel, u32 port, UartTx *fallback, UartDma_Done done, void *doneArg){
+        d->dma = dma;
+        d->channel = channel;
+        d->port = port;
+        d->fallback = fallback;
+        d->done = done;
+        d->doneArg = doneArg;
+        d->buffer = 0;
+        d->busy = 0;
+        d->stop.status = DMASG_DESCRIPTOR_STATUS_COMPLETED;
+        d->stop.control = 0;
+        d->stop.next = 0;
+        if(dma){
+            dmasg_output_stream(dma, channel, port, 0, 0, 0);
+            dmasg_interrupt_config(dma, channel, DMASG_CHANNEL_INTERRUPT_CHANNEL_COMPLETION_MASK);
+        }
+    }
+
+    static u32 uartDma_busy(UartDma *d){
+        return d->busy;
+    }
+
+    static void uartDma_complete(UartDma *d){
+        const char *buf = d->buffer;
+        d->buffer = 0;
+        d->busy = 0;
+        if(d->done) d->done(buf, d->doneArg);
+    }
+
+    /**
+    * Fill a linked list descriptor with one fragment
+    *
+    * @param desc descriptor to fill, must be aligned to 64 bytes
+    * @param buf fragment address
+    * @param len fragment size in bytes
+    * @param next next descriptor, null for the last fragment of the list
+    */
+    static void uartDma_descriptor(UartDma *d, struct dmasg_descriptor *desc, const char *buf, u32 len, struct dmasg_descriptor *next){
+        desc->status = 0;
+        desc->control = (len-1) & DMASG_DESCRIPTOR_CONTROL_BYTES;
+        desc->from = (u32) buf;
+        desc->to = 0;
+        desc->next = (u32) (next ? next : &d->stop);
+    }
+
+    /**
+    * Start the transmission of a buffer, returns immediately.
+    * The buffer must not be modified until the done callback is called.
+    *
+    * @param d transmitter instance
+    * @param buf data to send
+    * @param len number of bytes to send
+    *
+    * @return 1 if the transfer was started, 0 if a previous transfer is still running
+    */
+    static u32 uart_writeDma(UartDma *d, const char *buf, u32 len){
+        if(d->busy) return 0;
+        if(!len) return 1;
+        d->busy = 1;
+        d->buffer = buf;
+        if(!d->dma){
+            uartTx_writeBlocking(d->fallback, buf, len);
+            uartDma_complete(d);
+            return 1;
+        }
+        dmasg_input_memory(d->dma, d->channel, (u32) buf, UART_DMA_BYTES_PER_BURST);
+        dmasg_output_stream(d->dma, d->channel, d->port, 0, 0, 0);
+        dmasg_direct_start(d->dma, d->channel, len, 0);
+        return 1;
+    }
+
+    /**
+    * Start the transmission of a linked list of fragments built with uartDma_descriptor, returns immediately.
+    * buf is only used to identify the transfer in the done callback.
+    *
+    * @return 1 if the transfer was started, 0 if a previous transfer is still running
+    */
+    static u32 uart_writeDmaList(UartDma *d, struct dmasg_descriptor *head, const char *buf){
+        if(d->busy) return 0;
+        d->busy = 1;
+        d->buffer = buf;
+        if(!d->dma){
+            for(struct dmasg_descriptor *desc = head;desc != &d->stop;desc = (struct dmasg_descriptor *)(u32) desc->next){
+                const char *from = (const char *)(u32) desc->from;
+                u32 len = (desc->control & DMASG_DESCRIPTOR_CONTROL_BYTES) + 1;
+                uartTx_writeBlocking(d->fallback, from, len);
+            }
+            uartDma_complete(d);
+            return 1;
+        }
+        asm("fence w,w");
+        dmasg_input_memory(d->dma, d->channel, 0, UART_DMA_BYTES_PER_BURST);
+        dmasg_output_stream(d->dma, d->channel, d->port, 0, 0, 0);
+        dmasg_linked_list_start(d->dma, d->channel, (u32) head);
+        return 1;
+    }
+
+    /**
+    * Interrupt routine, to be called when the DMA channel interrupt is claimed.
+    */
+    static void uartDma_interrupt(UartDma *d){
+        if(!d->dma) return;
+        dmasg_interrupt_pending_clear(d->dma, d->channel, 0xFFFFFFFF);
+        if(d->busy && !dmasg_busy(d->dma, d->channel)) uartDma_complete(d);
+    }
+
+    // Wait until the current transfer is completed
+    static void uartDma_wait(UartDma *d){
+        while(d->busy);
+    }
+
+#ifndef UART_DMA_SINK_SIZE
+#define UART_DMA_SINK_SIZE 256
+#endif
+
+    // Double buffer used to send the output of the print functions with the DMA
+    typedef struct {
+        UartDma *dma;
+        u32 current;
+        char buffers[2][UART_DMA_SINK_SIZE];
+    } UartDma_Sink;
+
+    static void uartDma_sinkInit(UartDma_Sink *s, UartDma *d){
+        s->dma = d;
+        s->current = 0;
+    }
+
+    /**
+    * Output sink for bsp_setOutputSink, arg is the UartDma_Sink instance.
+    * The text is copied into one buffer while the other one is being sent, so a print
+    * only waits for the previous transfer, not for its own.
+    */
+    static void uartDma_sink(void *arg, const char *p, u32 len){
+        UartDma_Sink *s = (UartDma_Sink *) arg;
+        while(len){
+            u32 chunk = len < UART_DMA_SINK_SIZE ? len : UART_DMA_SINK_SIZE;
+            char *buffer = s->buffers[s->current];
+            for(u32 i = 0;i < chunk;i++) buffer[i] = p[i];
+            uartDma_wait(s->dma);
+            uart_writeDma(s->dma, buffer, chunk);
+            s->current ^= 1;
+            p += chunk;
+            len -= chunk;
+        }
+    }
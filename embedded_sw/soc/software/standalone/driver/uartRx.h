@@ -0,0 +1,254 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include "type.h"
+#include "io.h"
+#include "uart.h"
+
+// Interrupt driven UART receiver.
+// uartRx_interrupt() drains the whole RX FIFO into a RAM ring buffer each time the RX not
+// empty interrupt fires, so bursts of input are not lost while the application is busy.
+// The application trap handler has to call uartRx_interrupt() when the UART interrupt is
+// claimed from the PLIC (see uartInterruptDemo).
+//
+// The second half of the data array mirrors the first one, so any span of the ring buffer
+// is contiguous in memory: lines and tokens are handed to the application by pointer and
+// length, without copying. A line stays valid until uartRx_release() is called.
+
+// Size of the ring buffer in bytes, must be a power of two
+#ifndef UART_RX_RING_SIZE
+#define UART_RX_RING_SIZE   1024
+#endif
+
+#define UART_RX_RING_MASK   (UART_RX_RING_SIZE-1)
+
+    typedef struct {
+        u32 reg;
+        u32 echo;
+        // head is only written by the interrupt, tail only by the application
+        volatile u32 head;
+        volatile u32 tail;
+        // Application side line parser
+        u32 scan;
+        u32 lineEnd;
+        u32 skipLf;
+        // Statistics
+        volatile u32 overflows;
+        volatile u32 interruptCount;
+        volatile u32 maxBurst;
+        char data[2*UART_RX_RING_SIZE];
+    } UartRx;
+
+    /**
+    * Initialize the receiver and enable the UART RX not empty interrupt
+    *
+    * @param rx receiver instance
+    * @param reg UART base address
+    * @param echo 1 to send back the received characters from the interrupt, for interactive terminals
+    */
+    static void uartRx_init(UartRx *rx, u32 reg, u32 echo){
+        rx->reg = reg;
+        rx->echo = echo;
+        rx->head = 0;
+        rx->tail = 0;
+        rx->scan = 0;
+        rx->lineEnd = 0;
+        rx->skipLf = 0;
+        rx->overflows = 0;
+        rx->interruptCount = 0;
+        rx->maxBurst = 0;
+        uart_RX_NotemptyInterruptEna(reg, 1);
+    }
+
+    /**
+    * Interrupt routine, to be called when the UART interrupt is claimed.
+    * Bytes received while the ring buffer is full are dropped and counted in overflows.
+    *
+    * @param rx receiver instance
+    */
+    static void uartRx_interrupt(UartRx *rx){
+        u32 head = rx->head;
+        u32 tail = rx->tail;
+        u32 burst = 0;
+        u32 occupancy;
+        while((occupancy = uart_readOccupancy(rx->reg))){
+            burst += occupancy;
+            while(occupancy--){
+                char c = read_u32(rx->reg + UART_DATA);
+                if(head - tail == UART_RX_RING_SIZE){
+                    rx->overflows++;
+                    continue;
+                }
+                rx->data[head & UART_RX_RING_MASK] = c;
+                rx->data[(head & UART_RX_RING_MASK) + UART_RX_RING_SIZE] = c;
+                head++;
+                if(rx->echo){
+                    uart_write(rx->reg, c);
+                    if(c == '\r') uart_write(rx->reg, '\n');
+                }
+            }
+        }
+        asm("fence w,w");
+        rx->head = head;
+        rx->interruptCount++;
+        if(burst > rx->maxBurst) rx->maxBurst = burst;
+    }
+
+    // Number of received bytes not yet consumed
+    static u32 uartRx_available(UartRx *rx){
+        return rx->head - rx->tail;
+    }
+
+    /**
+    * Get all the received bytes without copying them, they stay valid until uartRx_consume()
+    *
+    * @return number of bytes available at *data
+    */
+    static u32 uartRx_peek(UartRx *rx, const char **data){
+        u32 head = rx->head;
+        asm("fence r,r");
+        *data = rx->data + (rx->tail & UART_RX_RING_MASK);
+        return head - rx->tail;
+    }
+
+    static void uartRx_consume(UartRx *rx, u32 length){
+        asm("fence rw,w");
+        rx->tail += length;
+        if((s32)(rx->scan - rx->tail) < 0) rx->scan = rx->tail;
+    }
+
+    // Copying read, returns the number of bytes copied
+    static u32 uartRx_read(UartRx *rx, char *buf, u32 len){
+        const char *data;
+        u32 available = uartRx_peek(rx, &data);
+        if(len > available) len = available;
+        for(u32 i = 0;i < len;i++) buf[i] = data[i];
+        uartRx_consume(rx, len);
+        return len;
+    }
+
+    /**
+    * Get the next line without copying it. Lines end with \r, \n or \r\n, the terminator isn't part of the line.
+    * A full ring buffer without any terminator is returned as a line, so it can't block the receiver.
+    *
+    * @param rx receiver instance
+    * @param line set to the first character of the line
+    * @param length set to the line length
+    *
+    * @return 1 if a line is available, it stays valid until uartRx_release()
+    */
+    static u32 uartRx_line(UartRx *rx, const char **line, u32 *length){
+        u32 head = rx->head;
+        asm("fence r,r");
+        if(rx->skipLf && rx->tail != head){
+            if(rx->data[rx->tail & UART_RX_RING_MASK] == '\n') uartRx_consume(rx, 1);
+            rx->skipLf = 0;
+        }
+        u32 tail = rx->tail;
+        for(;rx->scan != head;rx->scan++){
+            char c = rx->data[rx->scan & UART_RX_RING_MASK];
+            if(c == '\r' || c == '\n'){
+                *line = rx->data + (tail & UART_RX_RING_MASK);
+                *length = rx->scan - tail;
+                rx->lineEnd = rx->scan + 1;
+                rx->skipLf = c == '\r';
+                return 1;
+            }
+        }
+        if(head - tail == UART_RX_RING_SIZE){
+            *line = rx->data + (tail & UART_RX_RING_MASK);
+            *length = UART_RX_RING_SIZE;
+            rx->lineEnd = head;
+            return 1;
+        }
+        return 0;
+    }
+
+    // Give the space of the last line returned by uartRx_line back to the receiver
+    static void uartRx_release(UartRx *rx){
+        uartRx_consume(rx, rx->lineEnd - rx->tail);
+    }
+
+    /**
+    * Split the next space separated token out of a line, without copying
+    *
+    * @param text remaining part of the line, moved after the token
+    * @param length remaining length, updated
+    * @param token set to the first character of the token
+    *
+    * @return token length, 0 when there is no more token
+    */
+    static u32 uartRx_token(const char **text, u32 *length, const char **token){
+        const char *p = *text;
+        const char *end = p + *length;
+        while(p != end && (*p == ' ' || *p == '\t')) p++;
+        *token = p;
+        while(p != end && *p != ' ' && *p != '\t') p++;
+        *text = p;
+        *length = end - p;
+        return p - *token;
+    }
+
+    static u32 uartRx_tokenIs(const char *token, u32 length, const char *str){
+        for(u32 i = 0;i < length;i++){
+            if(token[i] != str[i]) return 0;
+        }
+        return str[length] == 0;
+    }
+
+    // Decimal or 0x prefixed hexadecimal token value, stops at the first invalid character
+    static u32 uartRx_tokenValue(const char *token, u32 length){
+        u32 value = 0;
+        u32 base = 10;
+        if(length > 2 && token[0] == '0' && (token[1] == 'x' || token[1] == 'X')){
+            base = 16;
+            token += 2;
+            length -= 2;
+        }
+        for(u32 i = 0;i < length;i++){
+            char c = token[i];
+            u32 digit;
+            if(c >= '0' && c <= '9') digit = c - '0';
+            else if(base == 16 && c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+            else if(base == 16 && c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+            else break;
+            value = value*base + digit;
+        }
+        return value;
+    }
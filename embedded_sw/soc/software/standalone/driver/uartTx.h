@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#pragma once
+
+#include "type.h"
+#include "io.h"
+#include "uart.h"
+#include "clint.h"
+
+// Interrupt driven UART transmitter.
+// uartTx_write() copies the data into a RAM ring buffer and returns immediately,
+// the UART TX FIFO empty interrupt then refills the hardware FIFO from the ring.
+// The application trap handler has to call uartTx_interrupt() when the UART
+// interrupt is claimed from the PLIC (see uartTxInterruptDemo).
+
+// Size of the ring buffer in bytes, must be a power of two
+#ifndef UART_TX_RING_SIZE
+#define UART_TX_RING_SIZE   4096
+#endif
+
+#define UART_TX_RING_MASK   (UART_TX_RING_SIZE-1)
+
+    typedef struct {
+        u32 reg;
+        // CLINT base address used to profile the interrupt routine, 0 to disable profiling
+        u32 clint;
+        // Free running indexes, head is only written by the application and tail by the interrupt
+        volatile u32 head;
+        volatile u32 tail;
+        // Statistics
+        u32 bytesQueued;
+        u32 bytesDropped;
+        volatile u32 interruptCount;
+        volatile u32 interruptTicks;
+        u8 data[UART_TX_RING_SIZE];
+    } UartTx;
+
+    /**
+    * Initialize the ring buffer of the given UART
+    *
+    * @param tx ring buffer instance
+    * @param reg UART base address
+    * @param clint CLINT base address used to measure the time spent in the interrupt, 0 to disable
+    */
+    static void uartTx_init(UartTx *tx, u32 reg, u32 clint){
+        tx->reg = reg;
+        tx->clint = clint;
+        tx->head = 0;
+        tx->tail = 0;
+        tx->bytesQueued = 0;
+        tx->bytesDropped = 0;
+        tx->interruptCount = 0;
+        tx->interruptTicks = 0;
+    }
+
+    // Number of bytes waiting in the ring buffer
+    static u32 uartTx_pending(UartTx *tx){
+        return tx->head - tx->tail;
+    }
+
+    // Number of bytes which can be queued without dropping
+    static u32 uartTx_space(UartTx *tx){
+        return UART_TX_RING_SIZE - uartTx_pending(tx);
+    }
+
+    // Move as many bytes as the hardware FIFO can take from the ring buffer.
+    // Only one context may call it at a time (interrupt or uartTx_flush with the interrupt disabled).
+    static void uartTx_fill(UartTx *tx){
+        u32 tail = tx->tail;
+        u32 head = tx->head;
+        u32 availability = uart_writeAvailability(tx->reg);
+        while(availability && tail != head){
+            write_u32(tx->data[tail & UART_TX_RING_MASK], tx->reg + UART_DATA);
+            tail++;
+            availability--;
+        }
+        tx->tail = tail;
+    }
+
+    /**
+    * Queue data for transmission, never wait on the UART
+    *
+    * @param tx ring buffer instance
+    * @param buf data to send
+    * @param len number of bytes to send
+    *
+    * @return number of bytes queued, lower than len if the ring buffer is full
+    */
+    static u32 uartTx_write(UartTx *tx, const char *buf, u32 len){
+        u32 head = tx->head;
+        u32 space = uartTx_space(tx);
+        if(len > space){
+            tx->bytesDropped += len - space;
+            len = space;
+        }
+        for(u32 i = 0;i < len;i++){
+            tx->data[(head + i) & UART_TX_RING_MASK] = buf[i];
+        }
+        asm("fence w,w");
+        tx->head = head + len;
+        tx->bytesQueued += len;
+        if(len) uart_TX_emptyInterruptEna(tx->reg, 1);
+        return len;
+    }
+
+    /**
+    * Queue data for transmission, waiting for room in the ring buffer when it is full.
+    * Requires the UART interrupt to be enabled.
+    *
+    * @param tx ring buffer instance
+    * @param buf data to send
+    * @param len number of bytes to send
+    */
+    static void uartTx_writeBlocking(UartTx *tx, const char *buf, u32 len){
+        while(len){
+            u32 space;
+            while((space = uartTx_space(tx)) == 0);
+            u32 chunk = len < space ? len : space;
+            uartTx_write(tx, buf, chunk);
+            buf += chunk;
+            len -= chunk;
+        }
+    }
+
+    static u32 uartTx_writeStr(UartTx *tx, const char *str){
+        u32 len = 0;
+        while(str[len]) len++;
+        return uartTx_write(tx, str, len);
+    }
+
+    /**
+    * Output sink for bsp_setOutputSink, arg is the UartTx instance.
+    * The print functions return as soon as the text is queued, they only wait when the ring buffer is full.
+    */
+    static void uartTx_sink(void *arg, const char *p, u32 len){
+        uartTx_writeBlocking((UartTx *) arg, p, len);
+    }
+
+    /**
+    * Interrupt routine, to be called when the UART interrupt is claimed.
+    * Refill the hardware FIFO and disable the TX interrupt once the ring buffer is empty.
+    *
+    * @param tx ring buffer instance
+    */
+    static void uartTx_interrupt(UartTx *tx){
+        u32 start = tx->clint ? clint_getTimeLow(tx->clint) : 0;
+        if(uart_status_read(tx->reg) & UART_STATUS_TX_INT_PENDING){
+            uartTx_fill(tx);
+            if(tx->tail == tx->head) uart_TX_emptyInterruptEna(tx->reg, 0);
+            tx->interruptCount++;
+        }
+        if(tx->clint) tx->interruptTicks += clint_getTimeLow(tx->clint) - start;
+    }
+
+    /**
+    * Wait until every queued byte left the UART TX FIFO.
+    * The remaining bytes are pushed by polling, so it also works with interrupts masked.
+    *
+    * @param tx ring buffer instance
+    */
+    static void uartTx_flush(UartTx *tx){
+        uart_TX_emptyInterruptEna(tx->reg, 0);
+        while(tx->tail != tx->head) uartTx_fill(tx);
+        while(uart_writeAvailability(tx->reg) != UART_TX_FIFO_DEPTH);
+    }
+
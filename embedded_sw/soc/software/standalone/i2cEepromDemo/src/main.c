@@ -40,6 +40,7 @@
 #include "riscv.h"
 #include "plic.h"
 #include "clint.h"
+#include "uartRx.h"
 #include "stdio.h"
 
 //function prototype
@@ -90,6 +91,7 @@ uint8_t 	write_data 			= 0;
 uint8_t 	number_of_byte		= 0;
 uint8_t 	read_data 			= 0;
 uint32_t 	address 			= 0;
+UartRx		uartRx;
 
 #define OPENING_STRING			"T120F324/T120F576 Dev Kit on-board EEPROM, AT24C01 i2c-demo !" \
 								"\r\nPlease make sure you are using the T120F324/T120F576 Dev Kit to run this demo! \r\n"
@@ -120,8 +122,8 @@ void main_init(){
 	// TX FIFO empty interrupt enable
 	//uart_TX_emptyInterruptEna(BSP_UART_TERMINAL,1);
 
-	// RX FIFO not empty interrupt enable
-	uart_RX_NotemptyInterruptEna(BSP_UART_TERMINAL,1);
+	// RX FIFO not empty interrupt enable, the received characters go to the uartRx ring buffer
+	uartRx_init(&uartRx, BSP_UART_TERMINAL, 1);
 
 	//configure PLIC
 	//cpu 0 accept all interrupts with priority above 0
@@ -166,24 +168,8 @@ void UartInterrupt_Sub()
         uart_status_write(BSP_UART_TERMINAL,uart_status_read(BSP_UART_TERMINAL) | 0x01);
     }
     else if (uart_status_read(BSP_UART_TERMINAL) & 0x00000200){
-
-//        bsp_printf("\nuart 0 rx fifo not empty interrupt routine \r\n");
-        // RX FIFO not empty interrupt Disable
-        uart_status_write(BSP_UART_TERMINAL,uart_status_read(BSP_UART_TERMINAL) & 0xFFFFFFFD);
-        //Dummy Read Clear FIFO
-        char uart_read_data = uart_read(BSP_UART_TERMINAL);
-        uart_write(BSP_UART_TERMINAL, uart_read_data);
-
-        if(uart_read_data == '\r'){ //if newline detected
-        	new_line_detected = 1;
-        	uart_write(BSP_UART_TERMINAL, '\r');
-        }
-        else{
-        	buffer[counter] = uart_read_data;
-        	counter++;
-        }
-        // RX FIFO not empty interrupt enable
-        uart_status_write(BSP_UART_TERMINAL,uart_status_read(BSP_UART_TERMINAL) | 0x02);
+        // Drain the whole RX FIFO into the ring buffer, lines are picked up by main()
+        uartRx_interrupt(&uartRx);
     }
 }
 
@@ -220,6 +206,17 @@ void main() {
     bsp_printf(FEATURE_SELECT_STRING);
 
     while(1){
+		if(!new_line_detected){
+			const char *line;
+			u32 length;
+			if(uartRx_line(&uartRx, &line, &length)){
+				//buffer is also used to hold the eeprom data, so the line is copied out of the ring buffer
+				if(length > sizeof(buffer)) length = sizeof(buffer);
+				for(counter = 0;counter < length;counter++) buffer[counter] = line[counter];
+				uartRx_release(&uartRx);
+				new_line_detected = 1;
+			}
+		}
 		switch(state){
 		case IDLE: //idle case wait for input to be 1 or 2
 			if(new_line_detected){
@@ -0,0 +1,92 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#include <stdint.h>
+#include "bsp.h"
+#include "riscv.h"
+#include "uart.h"
+
+// CPU cycles per bsp_printf call for each specifier. The TX FIFO is emptied before each
+// call and every output fits in it, so only the formatting is measured, not the baud rate.
+
+#define LOOPS       8
+#define FIFO_DEPTH  SYSTEM_UART_0_IO_PARAMETER_TX_FIFO_DEPTH
+
+void waitTxEmpty(){
+    while(uart_writeAvailability(BSP_UART_TERMINAL) != FIFO_DEPTH);
+}
+
+// Best of LOOPS, so the first call cache misses are not counted
+#define BENCH(name, call) do {                          \
+        u32 best = 0xFFFFFFFF;                          \
+        for(u32 i = 0;i < LOOPS;i++){                   \
+            waitTxEmpty();                              \
+            u32 t0 = csr_read(mcycle);                  \
+            call;                                       \
+            u32 cycles = csr_read(mcycle) - t0;         \
+            if(cycles < best) best = cycles;            \
+        }                                               \
+        waitTxEmpty();                                  \
+        bsp_printf("\r\n%s : %d cycles \r\n", name, best); \
+    } while(0)
+
+void main() {
+    bsp_init();
+    bsp_printf("printf cycles per call benchmark ! \r\n");
+
+    BENCH("%c         ", bsp_printf("%c", 'A'));
+    BENCH("%s         ", bsp_printf("%s", "string"));
+    BENCH("%d 7       ", bsp_printf("%d", 7));
+    BENCH("%d -123456 ", bsp_printf("%d", -123456));
+    BENCH("%d max     ", bsp_printf("%d", 2147483647));
+    BENCH("%x         ", bsp_printf("%x", 0xCAFE));
+    BENCH("%X         ", bsp_printf("%X", 0xCAFE));
+#if (ENABLE_FLOATING_POINT_SUPPORT)
+    BENCH("%f 3.1416  ", bsp_printf("%f", 3.14159265));
+    BENCH("%f -123456.789", bsp_printf("%f", -123456.789));
+#endif //#if (ENABLE_FLOATING_POINT_SUPPORT)
+
+#if (ENABLE_BSP_PRINTF_FULL)
+    char buffer[32];
+    BENCH("full %d    ", bsp_snprintf_full(buffer, sizeof(buffer), "%d", -123456));
+    BENCH("full %08x  ", bsp_snprintf_full(buffer, sizeof(buffer), "%08x", 0xCAFE));
+#if (ENABLE_FLOATING_POINT_SUPPORT)
+    BENCH("full %.2f  ", bsp_snprintf_full(buffer, sizeof(buffer), "%.2f", 3.14159265));
+    BENCH("full %.6f  ", bsp_snprintf_full(buffer, sizeof(buffer), "%.6f", -123456.789));
+#endif //#if (ENABLE_FLOATING_POINT_SUPPORT)
+#endif //#if (ENABLE_BSP_PRINTF_FULL)
+}
@@ -5,6 +5,7 @@
 #include "smpDemo.h"
 #include "bsp.h"
 #include "print.h"
+#include "hartLog.h"
 
 #define SMP_INUSE (HART_COUNT > 1)
 
@@ -82,42 +83,21 @@ void mainSmp(){
 
         u32 key_h0[4]={0x227C81AA, 0x7AE71DA8, 0x4ACF7AD5, 0x67E57113};
         tiny_algo_encrypter(input1, input2, key_h0, &h0_r1, &h0_r2);
+        hartLog_strHex("encrypted output A: ", h0_r1);
+        hartLog_strHex("encrypted output B: ", h0_r2);
 
 #if (HART_COUNT == 4)
-        while(!h1_ready && !h2_ready && !h3_ready);
-        asm("fence r,r");
-        timerCmp1 = clint_getTime(BSP_CLINT);
-        printPTime(timerCmp0,timerCmp1,"processing clock cycles:");
-        bsp_printf("hart 0 encrypted output A: %x \r\n", h0_r1);
-        bsp_printf("hart 0 encrypted output B: %x \r\n", h0_r2);
-        bsp_printf("hart 1 encrypted output A: %x \r\n", h1_r1);
-        bsp_printf("hart 1 encrypted output B: %x \r\n", h1_r2);
-        bsp_printf("hart 2 encrypted output A: %x \r\n", h2_r1);
-        bsp_printf("hart 2 encrypted output B: %x \r\n", h2_r2);
-        bsp_printf("hart 3 encrypted output A: %x \r\n", h3_r1);
-        bsp_printf("hart 3 encrypted output B: %x \r\n", h3_r2);
+        while(!(h1_ready && h2_ready && h3_ready));
 #elif (HART_COUNT == 3)
-        while(!h1_ready && !h2_ready);
-        asm("fence r,r");
-        timerCmp1 = clint_getTime(BSP_CLINT);
-        printPTime(timerCmp0,timerCmp1,"processing clock cycles:");
-        bsp_printf("hart 0 encrypted output A: %x \r\n", h0_r1);
-        bsp_printf("hart 0 encrypted output B: %x \r\n", h0_r2);
-        bsp_printf("hart 1 encrypted output A: %x \r\n", h1_r1);
-        bsp_printf("hart 1 encrypted output B: %x \r\n", h1_r2);
-        bsp_printf("hart 2 encrypted output A: %x \r\n", h2_r1);
-        bsp_printf("hart 2 encrypted output B: %x \r\n", h2_r2);
+        while(!(h1_ready && h2_ready));
 #else
         while(!h1_ready);
+#endif
         asm("fence r,r");
         timerCmp1 = clint_getTime(BSP_CLINT);
         printPTime(timerCmp0,timerCmp1,"processing clock cycles:");
-        bsp_printf("hart 0 encrypted output A: %x \r\n", h0_r1);
-        bsp_printf("hart 0 encrypted output B: %x \r\n", h0_r2);
-        bsp_printf("hart 1 encrypted output A: %x \r\n", h1_r1);
-        bsp_printf("hart 1 encrypted output B: %x \r\n", h1_r2);
-#endif
-
+        //Every hart logged into its own ring, hart 0 is the only one writing to the UART
+        hartLog_drain();
     }
     else if(hartId == 1){
         while(!h0_ready);
@@ -125,7 +105,10 @@ void mainSmp(){
         u32 inp1_h1 = (volatile u32)input1;
         u32 inp2_h1 = (volatile u32)input2;
         u32 key_h1[4]={0x248a0135, 0x529C7762, 0x5688593F, 0xF9A7B565};
+        hartLog_str("start");
         tiny_algo_encrypter(inp1_h1, inp2_h1, key_h1, &h1_r1, &h1_r2);
+        hartLog_strHex("encrypted output A: ", h1_r1);
+        hartLog_strHex("encrypted output B: ", h1_r2);
         asm("fence w,w");
         h1_ready = 1;
     }
@@ -135,7 +118,10 @@ void mainSmp(){
         u32 inp1_h2 = (volatile u32)input1;
         u32 inp2_h2 = (volatile u32)input2;
         u32 key_h2[4]={0x3AAE508A, 0xC58CCC20, 0x8CA79D11, 0x038C6414};
+        hartLog_str("start");
         tiny_algo_encrypter(inp1_h2, inp2_h2, key_h2, &h2_r1, &h2_r2);
+        hartLog_strHex("encrypted output A: ", h2_r1);
+        hartLog_strHex("encrypted output B: ", h2_r2);
         asm("fence w,w");
         h2_ready = 1;
     }
@@ -145,7 +131,10 @@ void mainSmp(){
         u32 inp1_h3 = (volatile u32)input1;
         u32 inp2_h3 = (volatile u32)input2;
         u32 key_h3[4]={0x248a0135, 0x5BB6136C, 0xC7E9CA03, 0xE4407CF3};
+        hartLog_str("start");
         tiny_algo_encrypter(inp1_h3, inp2_h3, key_h3, &h3_r1, &h3_r2);
+        hartLog_strHex("encrypted output A: ", h3_r1);
+        hartLog_strHex("encrypted output B: ", h3_r2);
         asm("fence w,w");
         h3_ready = 1;
     }
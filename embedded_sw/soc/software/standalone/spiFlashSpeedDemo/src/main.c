@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#include <stdint.h>
+#include "bsp.h"
+#include "clint.h"
+#include "spi.h"
+#include "spiFlash.h"
+#include "crc32.h"
+
+// Time the copy of the bootloader user image from the SPI flash, as bspMain() in
+// bootloaderConfig.h does it, with the previous byte per spi_read() loop and with the
+// pipelined word loop of spiFlash_read_(), in single, dual and quad data modes.
+// The image doesn't fit in RAM next to this demo, it is copied in CHUNK_SIZE chunks, each
+// chunk is a read command of its own. Both loops must give the same CRC32.
+// Dual and quad need all the flash data lines connected to the FPGA.
+
+#define SPI SYSTEM_SPI_0_IO_CTRL
+#define SPI_CS 0
+
+//Same image as bootloaderConfig.h, keep USER_SOFTWARE_SIZE in sync with it
+#define USER_SOFTWARE_FLASH  0x00380000
+#define USER_SOFTWARE_SIZE   0x3f000
+
+#define CHUNK_SIZE  0x8000
+#define MODE_SINGLE 0
+#define MODE_DUAL   1
+#define MODE_QUAD   2
+
+u32 chunk[CHUNK_SIZE/4];
+
+//Copy loop of spiFlash_f2m_, spiFlash_dual_f2m_ and spiFlash_quad_f2m_ before the pipelined read
+void byteRead(u32 mode, u32 flashAddress, u32 memoryAddress, u32 size){
+    static const u8 commands[] = {0x0B, 0x3B, 0x6B};
+    spiFlash_select(SPI, SPI_CS);
+    spi_write(SPI, commands[mode]);
+    spi_write(SPI, flashAddress >> 16);
+    spi_write(SPI, flashAddress >>  8);
+    spi_write(SPI, flashAddress >>  0);
+    spi_write(SPI, 0);
+    if(mode != MODE_SINGLE){
+        spi_waitXferBusy(SPI);
+        spiFlash_init_mode_(SPI, mode);
+    }
+    uint8_t *ram = (uint8_t *) memoryAddress;
+    for(u32 idx = 0;idx < size;idx++){
+        u8 value = spi_read(SPI);
+        *ram++ = value;
+    }
+    if(mode != MODE_SINGLE) spiFlash_init_mode_(SPI, 0);
+    spiFlash_diselect(SPI, SPI_CS);
+}
+
+void pipelinedRead(u32 mode, u32 flashAddress, u32 memoryAddress, u32 size){
+    switch(mode){
+    case MODE_SINGLE: spiFlash_f2m(SPI, SPI_CS, flashAddress, memoryAddress, size); break;
+    case MODE_DUAL: spiFlash_f2m_dual(SPI, SPI_CS, flashAddress, memoryAddress, size); break;
+    default: spiFlash_f2m_quad(SPI, SPI_CS, flashAddress, memoryAddress, size); break;
+    }
+}
+
+/**
+* Copy the whole image chunk by chunk
+*
+* @param byteLoop 1 for the byte per spi_read() loop, 0 for the pipelined loop
+* @param crc set to the CRC32 of the image
+*
+* @return copy time in microseconds, the CRC32 isn't part of it
+*/
+u32 copyImage(u32 mode, u32 byteLoop, u32 *crc){
+    u64 ticks = 0;
+    u32 state = CRC32_INIT;
+    for(u32 offset = 0;offset < USER_SOFTWARE_SIZE;offset += CHUNK_SIZE){
+        u32 size = USER_SOFTWARE_SIZE - offset < CHUNK_SIZE ? USER_SOFTWARE_SIZE - offset : CHUNK_SIZE;
+        u64 t0 = clint_getTime(BSP_CLINT);
+        if(byteLoop) byteRead(mode, USER_SOFTWARE_FLASH + offset, (u32)chunk, size);
+        else pipelinedRead(mode, USER_SOFTWARE_FLASH + offset, (u32)chunk, size);
+        ticks += clint_getTime(BSP_CLINT) - t0;
+        state = crc32_update(state, chunk, size);
+    }
+    *crc = crc32_final(state);
+    return (u32)(ticks/(BSP_CLINT_HZ/1000000));
+}
+
+void main() {
+    static const char *names[] = {"single", "dual  ", "quad  "};
+    bsp_init();
+    spiFlash_init(SPI, SPI_CS);
+    spiFlash_wake(SPI, SPI_CS);
+    bsp_printf("spi flash speed demo, %d bytes image at %x \r\n", USER_SOFTWARE_SIZE, USER_SOFTWARE_FLASH);
+
+    for(u32 mode = MODE_SINGLE;mode <= MODE_QUAD;mode++){
+        u32 byteCrc, pipelinedCrc;
+        u32 byteUs = copyImage(mode, 1, &byteCrc);
+        u32 pipelinedUs = copyImage(mode, 0, &pipelinedCrc);
+        u32 speedup = (u32)((u64)byteUs*100/pipelinedUs);
+        //bytes per microsecond are megabytes per second
+        u32 rate = (u32)((u64)USER_SOFTWARE_SIZE*100/pipelinedUs);
+        bsp_printf("%s : byte loop %d us, pipelined %d us, speedup %d.%d%d, %d.%d%d MB/s, crc %x %s\r\n", names[mode],
+            byteUs, pipelinedUs, speedup/100, speedup/10%10, speedup%10, rate/100, rate/10%10, rate%10,
+            pipelinedCrc, byteCrc == pipelinedCrc ? "ok" : "MISMATCH");
+    }
+    bsp_printf("spi flash speed demo done \r\n");
+    while(1){}
+}
@@ -0,0 +1,225 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#include <stdint.h>
+#include "plic.h"
+#include "clint.h"
+#include "bsp.h"
+#include "riscv.h"
+#include "telemetry.h"
+
+// Run tool/telemetryDemux.py on the host to see the text and the decoded records side by side.
+// Commands from the host : 1 reset the counters, 2 set the report period in frames, 3 send the histogram now.
+
+#define CMD_RESET       1
+#define CMD_PERIOD      2
+#define CMD_HISTOGRAM   3
+
+#define COUNTER_FRAMES      0
+#define COUNTER_COMMANDS    1
+#define COUNTER_RX_ERRORS   2
+
+#define HISTOGRAM_RENDER    0
+#define BIN_WIDTH           2000
+
+void init();
+void main();
+void trap();
+void crash();
+void trap_entry();
+void UartInterrupt();
+
+Telemetry telemetry;
+Telemetry_Histogram renderHistogram;
+u32 frames, commands, period = 50;
+volatile u32 renderSink; // Keeps the result of render(), so the compiler can't drop the work
+
+// What is typed on the console, echoed by main between frames. Writing it from the interrupt
+// could put a byte in the middle of a telemetry frame. Power of two, bytes are dropped when full.
+#define ECHO_SIZE 64
+char echo[ECHO_SIZE];
+volatile u32 echoHead, echoTail;
+
+void textInput(void *arg, char c){
+    if(echoHead - echoTail == ECHO_SIZE) return;
+    echo[echoHead & (ECHO_SIZE-1)] = c;
+    echoHead++;
+}
+
+void echoText(){
+    while(echoTail != echoHead){
+        uart_write(BSP_UART_TERMINAL, echo[echoTail & (ECHO_SIZE-1)]);
+        echoTail++;
+    }
+}
+
+void init(){
+    telemetry_init(&telemetry, BSP_UART_TERMINAL, 0, 0, textInput, 0);
+
+    // RX FIFO not empty interrupt enable
+    uart_RX_NotemptyInterruptEna(BSP_UART_TERMINAL, 1);
+
+    //configure PLIC
+    //cpu 0 accept all interrupts with priority above 0
+    plic_set_threshold(BSP_PLIC, BSP_PLIC_CPU_0, 0);
+
+    plic_set_enable(BSP_PLIC, BSP_PLIC_CPU_0, SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, 1);
+    plic_set_priority(BSP_PLIC, SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, 1);
+
+    //enable interrupts
+    csr_write(mtvec, trap_entry); //Set the machine trap vector (../common/trap.S)
+    csr_set(mie, MIE_MEIE); //Enable external interrupts
+    csr_write(mstatus, MSTATUS_MPP | MSTATUS_MIE);
+}
+
+//Called by trap_entry on both exceptions and interrupts events
+void trap(){
+    int32_t mcause = csr_read(mcause);
+    //Interrupt if set, exception if cleared
+    int32_t interrupt = mcause < 0;
+    int32_t cause     = mcause & 0xF;
+
+    if(interrupt){
+        switch(cause){
+        case CAUSE_MACHINE_EXTERNAL: UartInterrupt(); break;
+        default: crash(); break;
+        }
+    } else {
+        crash();
+    }
+}
+
+void UartInterrupt()
+{
+    uint32_t claim;
+    //While there is pending interrupts
+    while(claim = plic_claim(BSP_PLIC, BSP_PLIC_CPU_0)){
+        switch(claim){
+        case SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT: telemetry_interrupt(&telemetry); break;
+        default: crash(); break;
+        }
+        //unmask the claimed interrupt
+        plic_release(BSP_PLIC, BSP_PLIC_CPU_0, claim);
+    }
+}
+
+void crash(){
+    bsp_printf("\r\n*** CRASH ***\r\n");
+    while(1);
+}
+
+void resetStats(){
+    frames = 0;
+    commands = 0;
+    renderHistogram.id = HISTOGRAM_RENDER;
+    renderHistogram.binCount = TELEMETRY_HISTOGRAM_BINS;
+    renderHistogram.binWidth = BIN_WIDTH;
+    for(u32 i = 0;i < TELEMETRY_HISTOGRAM_BINS;i++) renderHistogram.bins[i] = 0;
+}
+
+void sendCounters(){
+    telemetry_counter(&telemetry, COUNTER_FRAMES, frames);
+    telemetry_counter(&telemetry, COUNTER_COMMANDS, commands);
+    telemetry_counter(&telemetry, COUNTER_RX_ERRORS, telemetry.rxErrors);
+}
+
+void pollCommands(){
+    const u8 *payload;
+    u32 length;
+    while(telemetry_command(&telemetry, &payload, &length) == TELEMETRY_COMMAND){
+        Telemetry_Command command;
+        u32 status = 0;
+        commands++;
+        if(length == sizeof(command)){
+            for(u32 i = 0;i < sizeof(command);i++) ((u8*)&command)[i] = payload[i];
+            switch(command.command){
+            case CMD_RESET: resetStats(); break;
+            case CMD_PERIOD: if(command.argument) period = command.argument; else status = 1; break;
+            case CMD_HISTOGRAM: telemetry_histogram(&telemetry, &renderHistogram); break;
+            default: status = 1; break;
+            }
+        } else {
+            command.command = 0;
+            status = 1;
+        }
+        telemetry_commandDone(&telemetry);
+        telemetry_ack(&telemetry, command.command, status);
+    }
+    // Other frame types are ignored
+    if(telemetry_command(&telemetry, &payload, &length)) telemetry_commandDone(&telemetry);
+}
+
+//Stand in for a frame of work with a varying cost
+u32 render(u32 frame){
+    u32 acc = 0;
+    u32 loops = 2000 + ((frame * 7919) % 16) * 500;
+    for(u32 i = 0;i < loops;i++) acc += i*frame;
+    return acc;
+}
+
+void main() {
+    Telemetry_FrameTiming timing;
+
+    init();
+    resetStats();
+    bsp_printf("telemetry demo ! \r\n");
+
+    while(1){
+        u32 t0 = clint_getTimeLow(BSP_CLINT);
+        renderSink += render(frames);
+        u32 t1 = clint_getTimeLow(BSP_CLINT);
+        u32 renderTicks = t1 - t0;
+        u32 bin = renderTicks / BIN_WIDTH;
+        renderHistogram.bins[bin < TELEMETRY_HISTOGRAM_BINS ? bin : TELEMETRY_HISTOGRAM_BINS-1]++;
+
+        timing.frame = frames;
+        timing.renderTicks = renderTicks;
+        timing.transmitTicks = 0;
+        timing.bytes = sizeof(timing);
+        telemetry_frameTiming(&telemetry, &timing);
+        frames++;
+
+        if(frames % period == 0){
+            sendCounters();
+            telemetry_histogram(&telemetry, &renderHistogram);
+            bsp_printf("frame %d, text and telemetry share the uart\r\n", frames);
+        }
+        pollCommands();
+        echoText();
+        bsp_uDelay(10000);
+    }
+}
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#include <stdint.h>
+#include "bsp.h"
+#include "clint.h"
+#include "uart.h"
+#include "print_token.h"
+
+// Run with tool/tokenDecode.py to see the tokenized lines, a plain terminal shows them as binary frames.
+
+#define LOOPS       16
+#define FIFO_DEPTH  SYSTEM_UART_0_IO_PARAMETER_TX_FIFO_DEPTH
+
+static const char name[] = "sensor";
+
+void waitTxEmpty(){
+    while(uart_writeAvailability(BSP_UART_TERMINAL) != FIFO_DEPTH);
+}
+
+void main() {
+    uint64_t t0, textTicks, tokenTicks;
+
+    bsp_init();
+    bsp_printf("tokenized printf demo ! \r\n");
+
+    waitTxEmpty();
+    t0 = clint_getTime(BSP_CLINT);
+    for(u32 i = 0;i < LOOPS;i++){
+        bsp_printf("%s %d : status %x, count %d \r\n", name, i, 0xCAFE0000 | i, i*1000);
+    }
+    waitTxEmpty();
+    textTicks = clint_getTime(BSP_CLINT) - t0;
+
+    t0 = clint_getTime(BSP_CLINT);
+    for(u32 i = 0;i < LOOPS;i++){
+        bsp_printf_token("%s %d : status %x, count %d \r\n", name, i, 0xCAFE0000 | i, i*1000);
+    }
+    waitTxEmpty();
+    tokenTicks = clint_getTime(BSP_CLINT) - t0;
+
+    bsp_printf_token("token %d, negative %d, char %c \r\n", LOOPS, -LOOPS, 'T');
+#if (ENABLE_FLOATING_POINT_SUPPORT)
+    bsp_printf_token("float %f \r\n", 3.1415f);
+#endif //#if (ENABLE_FLOATING_POINT_SUPPORT)
+
+    bsp_printf("\r\n%d lines, clint ticks until the last byte is sent \r\n", LOOPS);
+    bsp_printf("bsp_printf       : %d \r\n", (u32)textTicks);
+    bsp_printf("bsp_printf_token : %d \r\n", (u32)tokenTicks);
+}
@@ -0,0 +1,106 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#include <stdint.h>
+#include "bsp.h"
+#include "clint.h"
+#include "uart.h"
+#include "uartBaud.h"
+
+#define UART_HZ         BSP_CLINT_HZ
+#define DEFAULT_BAUD    SYSTEM_UART_0_IO_PARAMETER_INIT_CONFIG_BAUDRATE
+#define TIMEOUT_US      2000000
+#define TEST_SIZE       65536
+
+const u32 rates[] = {3000000, 2500000, 2000000, 1000000, 921600};
+#define RATE_COUNT (sizeof(rates)/sizeof(rates[0]))
+
+static char testPattern(u32 i){
+    return '0' + (i & 0x3F);
+}
+
+//Stream TEST_SIZE bytes to the host, then check the host echo of the same pattern
+void throughputTest(u32 baudrate){
+    u32 t0, txTicks, errors = 0, received = 0;
+    char buffer[64];
+
+    uart_writeStr(BSP_UART_TERMINAL, "#TEST ");
+    uartBaud_writeDec(BSP_UART_TERMINAL, TEST_SIZE);
+    uart_writeStr(BSP_UART_TERMINAL, "\r\n");
+
+    t0 = clint_getTimeLow(BSP_CLINT);
+    for(u32 offset = 0;offset < TEST_SIZE;offset += sizeof(buffer)){
+        for(u32 i = 0;i < sizeof(buffer);i++) buffer[i] = testPattern(offset + i);
+        uart_writeBuf(BSP_UART_TERMINAL, buffer, sizeof(buffer));
+    }
+    while(uart_writeAvailability(BSP_UART_TERMINAL) != UART_TX_FIFO_DEPTH);
+    txTicks = clint_getTimeLow(BSP_CLINT) - t0;
+
+    u32 deadline = clint_getTimeLow(BSP_CLINT) + TIMEOUT_US*(UART_HZ/1000000);
+    while(received < TEST_SIZE && (s32)(deadline - clint_getTimeLow(BSP_CLINT)) > 0){
+        if(!uart_readOccupancy(BSP_UART_TERMINAL)) continue;
+        char c = read_u32(BSP_UART_TERMINAL + UART_DATA);
+        if(c != testPattern(received)) errors++;
+        received++;
+    }
+    errors += TEST_SIZE - received;
+
+    bsp_printf("#RESULT %d %d %d %d %d\r\n", baudrate, uartBaud_divider(UART_HZ, baudrate), errors, txTicks,
+        (u32)(((u64)TEST_SIZE * UART_HZ) / txTicks));
+}
+
+void main() {
+    bsp_init();
+    bsp_printf("uart baudrate negotiation demo ! \r\n");
+    bsp_printf("uart clock %d Hz, %d samples per bit \r\n", UART_HZ, UART_BAUD_SAMPLE_PER_BIT);
+    for(u32 i = 0;i < RATE_COUNT;i++){
+        u32 divider = uartBaud_divider(UART_HZ, rates[i]);
+        u32 error = uartBaud_error(UART_HZ, rates[i]);
+        bsp_printf("%d baud : divider %d, real %d baud, error %d/1000 %s\r\n", rates[i], divider,
+            uartBaud_actual(UART_HZ, divider), error, error > UART_BAUD_MAX_ERROR ? "(not proposed)" : "");
+    }
+
+    while(1){
+        u32 baudrate = uartBaud_negotiate(BSP_UART_TERMINAL, UART_HZ, BSP_CLINT, DEFAULT_BAUD, rates, RATE_COUNT, TIMEOUT_US);
+        if(baudrate != DEFAULT_BAUD){
+            throughputTest(baudrate);
+            uartBaud_apply(BSP_UART_TERMINAL, UART_HZ, DEFAULT_BAUD);
+        }
+        bsp_uDelay(500000);
+    }
+}
+
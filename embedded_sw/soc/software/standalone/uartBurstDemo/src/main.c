@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#include <stdint.h>
+#include "bsp.h"
+#include "clint.h"
+#include "uart.h"
+
+#define FRAME_SIZE  4096
+#define FIFO_DEPTH  SYSTEM_UART_0_IO_PARAMETER_TX_FIFO_DEPTH
+
+char frame[FRAME_SIZE];
+
+void waitTxEmpty(){
+    while(uart_writeAvailability(BSP_UART_TERMINAL) != FIFO_DEPTH);
+}
+
+//CPU time needed to push the frame, measured one FIFO load at a time so the wire time is not counted
+uint64_t pushPerByte(){
+    uint64_t ticks = 0;
+    for(u32 offset = 0;offset < FRAME_SIZE;offset += FIFO_DEPTH){
+        waitTxEmpty();
+        uint64_t t0 = clint_getTime(BSP_CLINT);
+        for(u32 i = 0;i < FIFO_DEPTH;i++) uart_write(BSP_UART_TERMINAL, frame[offset + i]);
+        ticks += clint_getTime(BSP_CLINT) - t0;
+    }
+    return ticks;
+}
+
+uint64_t pushBurst(){
+    uint64_t ticks = 0;
+    for(u32 offset = 0;offset < FRAME_SIZE;offset += FIFO_DEPTH){
+        waitTxEmpty();
+        uint64_t t0 = clint_getTime(BSP_CLINT);
+        uart_writeBuf(BSP_UART_TERMINAL, frame + offset, FIFO_DEPTH);
+        ticks += clint_getTime(BSP_CLINT) - t0;
+    }
+    return ticks;
+}
+
+void main() {
+    uint64_t t0, wirePerByte, wireBurst, cpuPerByte, cpuBurst;
+
+    bsp_init();
+    bsp_printf("uart burst write benchmark ! \r\n");
+
+    for(u32 i = 0;i < FRAME_SIZE;i++){
+        frame[i] = (i % 64) == 63 ? '\n' : ' ' + (i % 64);
+    }
+
+    //Whole frame, bounded by the baud rate
+    waitTxEmpty();
+    t0 = clint_getTime(BSP_CLINT);
+    for(u32 i = 0;i < FRAME_SIZE;i++) uart_write(BSP_UART_TERMINAL, frame[i]);
+    waitTxEmpty();
+    wirePerByte = clint_getTime(BSP_CLINT) - t0;
+
+    t0 = clint_getTime(BSP_CLINT);
+    uart_writeBuf(BSP_UART_TERMINAL, frame, FRAME_SIZE);
+    waitTxEmpty();
+    wireBurst = clint_getTime(BSP_CLINT) - t0;
+
+    //CPU cost only
+    cpuPerByte = pushPerByte();
+    cpuBurst = pushBurst();
+    waitTxEmpty();
+
+    bsp_printf("\r\n%d bytes frame, clint ticks \r\n", FRAME_SIZE);
+    bsp_printf("uart_write    : cpu %d wire %d \r\n", (u32)cpuPerByte, (u32)wirePerByte);
+    bsp_printf("uart_writeBuf : cpu %d wire %d \r\n", (u32)cpuBurst, (u32)wireBurst);
+    bsp_printf("cpu ticks per byte x100 : %d -> %d \r\n", (u32)(cpuPerByte*100/FRAME_SIZE), (u32)(cpuBurst*100/FRAME_SIZE));
+}
+
@@ -0,0 +1,177 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#include <stdint.h>
+#include "plic.h"
+#include "clint.h"
+#include "bsp.h"
+#include "riscv.h"
+#include "uartTx.h"
+#include "uartDma.h"
+#include "uartDmaDemo.h"
+
+#define FRAME_WIDTH  80
+#define FRAME_HEIGHT 22
+#define FRAME_SIZE   (FRAME_HEIGHT*(FRAME_WIDTH+2))
+
+void init();
+void main();
+void trap();
+void crash();
+void trap_entry();
+void externalInterrupt();
+
+UartTx uartTx;
+UartDma uartDma;
+
+//Two frames, one is rendered while the other one is streamed
+char frames[2][FRAME_SIZE] __attribute__ ((aligned (64)));
+volatile u32 frameFree[2] = {1, 1};
+
+//One descriptor per line for the scatter gather transfer
+struct dmasg_descriptor lines[FRAME_HEIGHT] __attribute__ ((aligned (64)));
+
+//Called from the interrupt once the DMA does not need the buffer anymore
+void frameDone(const char *buf, void *arg){
+    frameFree[buf == frames[1]] = 1;
+}
+
+void init(){
+    uartTx_init(&uartTx, BSP_UART_TERMINAL, 0);
+    uartDma_init(&uartDma, UART_DMASG_CTRL, UART_DMASG_CHANNEL, UART_DMASG_PORT, &uartTx, frameDone, 0);
+
+    //configure PLIC
+    //cpu 0 accept all interrupts with priority above 0
+    plic_set_threshold(BSP_PLIC, BSP_PLIC_CPU_0, 0);
+
+    plic_set_enable(BSP_PLIC, BSP_PLIC_CPU_0, SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, 1);
+    plic_set_priority(BSP_PLIC, SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, 1);
+#ifdef UART_DMASG_PLIC_INTERRUPT
+    plic_set_enable(BSP_PLIC, BSP_PLIC_CPU_0, UART_DMASG_PLIC_INTERRUPT, 1);
+    plic_set_priority(BSP_PLIC, UART_DMASG_PLIC_INTERRUPT, 1);
+#endif
+
+    //enable interrupts
+    csr_write(mtvec, trap_entry); //Set the machine trap vector (../common/trap.S)
+    csr_set(mie, MIE_MEIE); //Enable external interrupts
+    csr_write(mstatus, MSTATUS_MPP | MSTATUS_MIE);
+}
+
+//Called by trap_entry on both exceptions and interrupts events
+void trap(){
+    int32_t mcause = csr_read(mcause);
+    //Interrupt if set, exception if cleared
+    int32_t interrupt = mcause < 0;
+    int32_t cause     = mcause & 0xF;
+
+    if(interrupt){
+        switch(cause){
+        case CAUSE_MACHINE_EXTERNAL: externalInterrupt(); break;
+        default: crash(); break;
+        }
+    } else {
+        crash();
+    }
+}
+
+void externalInterrupt(){
+    uint32_t claim;
+    //While there is pending interrupts
+    while(claim = plic_claim(BSP_PLIC, BSP_PLIC_CPU_0)){
+        switch(claim){
+        case SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT: uartTx_interrupt(&uartTx); break;
+#ifdef UART_DMASG_PLIC_INTERRUPT
+        case UART_DMASG_PLIC_INTERRUPT: uartDma_interrupt(&uartDma); break;
+#endif
+        default: crash(); break;
+        }
+        //unmask the claimed interrupt
+        plic_release(BSP_PLIC, BSP_PLIC_CPU_0, claim);
+    }
+}
+
+void crash(){
+    uartTx_flush(&uartTx);
+    bsp_printf("\r\n*** CRASH ***\r\n");
+    while(1);
+}
+
+void buildFrame(char *frame, u32 offset){
+    char *p = frame;
+    for(u32 y = 0;y < FRAME_HEIGHT;y++){
+        for(u32 x = 0;x < FRAME_WIDTH;x++){
+            *p++ = ".,-~:;=!*#$@"[(x + y + offset) % 12];
+        }
+        *p++ = '\r';
+        *p++ = '\n';
+    }
+}
+
+void main() {
+    u32 t0, frameCount = 0;
+
+    init();
+    bsp_printf("uart dma demo ! \r\n");
+    if(!UART_DMASG_CTRL) bsp_printf("no DMA channel connected to the UART, using the interrupt driven ring buffer \r\n");
+    uartTx_flush(&uartTx);
+
+    //Whole frame in one transfer
+    t0 = clint_getTimeLow(BSP_CLINT);
+    for(u32 offset = 0;offset < 100;offset++){
+        u32 id = offset & 1;
+        while(!frameFree[id]);
+        frameFree[id] = 0;
+        buildFrame(frames[id], offset);
+        while(!uart_writeDma(&uartDma, frames[id], FRAME_SIZE));
+        frameCount++;
+    }
+    uartDma_wait(&uartDma);
+    uartTx_flush(&uartTx);
+    bsp_printf("\r\n%d frames in %d ticks \r\n", frameCount, clint_getTimeLow(BSP_CLINT) - t0);
+
+    //Same frame sent as a linked list of one descriptor per line, each line with its \r\n
+    buildFrame(frames[0], 0);
+    for(u32 y = 0;y < FRAME_HEIGHT;y++){
+        uartDma_descriptor(&uartDma, &lines[y], frames[0] + y*(FRAME_WIDTH+2), FRAME_WIDTH+2, y == FRAME_HEIGHT-1 ? 0 : &lines[y+1]);
+    }
+    frameFree[0] = 0;
+    while(!uart_writeDmaList(&uartDma, lines, frames[0]));
+    uartDma_wait(&uartDma);
+    uartTx_flush(&uartTx);
+    bsp_printf("\r\nlinked list transfer done \r\n");
+}
+
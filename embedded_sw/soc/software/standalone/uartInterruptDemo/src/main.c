@@ -41,6 +41,7 @@
 #include "clint.h"
 #include "bsp.h"
 #include "riscv.h"
+#include "uartRx.h"
 
 void init();
 void main();
@@ -52,6 +53,8 @@ void UartInterrupt();
 #define UART_A_SAMPLE_PER_BAUD 8
 #define CORE_HZ BSP_CLINT_HZ
 
+UartRx uartRx;
+
 void init(){
     //UART init
     Uart_Config uartA;
@@ -64,8 +67,8 @@ void init(){
     // TX FIFO empty interrupt enable
     //uart_TX_emptyInterruptEna(BSP_UART_TERMINAL,1);   
     
-    // RX FIFO not empty interrupt enable
-    uart_RX_NotemptyInterruptEna(BSP_UART_TERMINAL,1);  
+    // RX FIFO not empty interrupt enable, the received characters go to the uartRx ring buffer
+    uartRx_init(&uartRx, BSP_UART_TERMINAL, 1);
 
     //configure PLIC
     //cpu 0 accept all interrupts with priority above 0
@@ -109,14 +112,8 @@ void UartInterrupt_Sub()
         uart_status_write(BSP_UART_TERMINAL,uart_status_read(BSP_UART_TERMINAL) | 0x01); 
     }
     else if (uart_status_read(BSP_UART_TERMINAL) & 0x00000200){
-
-        bsp_printf("\nuart 0 rx fifo not empty interrupt routine \r\n");
-        // RX FIFO not empty interrupt Disable
-        uart_status_write(BSP_UART_TERMINAL,uart_status_read(BSP_UART_TERMINAL) & 0xFFFFFFFD);          
-        //Dummy Read Clear FIFO
-        uart_write(BSP_UART_TERMINAL, uart_read(BSP_UART_TERMINAL));    
-        // RX FIFO not empty interrupt enable
-        uart_status_write(BSP_UART_TERMINAL,uart_status_read(BSP_UART_TERMINAL) | 0x02);                    
+        // Drain the whole RX FIFO into the ring buffer
+        uartRx_interrupt(&uartRx);
     }
 }
 
@@ -145,11 +142,25 @@ void main() {
 
     bsp_printf("uart 0 interrupt demo ! \r\n");
     bsp_printf("start typing on terminal to interrupt uart... \r\n");
+    bsp_printf("lines are parsed from the rx ring buffer, try \"add 12 0x30\" \r\n");
     while(1){
-        while(uart_readOccupancy(BSP_UART_TERMINAL)){
-            uart_write(BSP_UART_TERMINAL, uart_read(BSP_UART_TERMINAL));
+        const char *line, *token;
+        u32 length, tokenLength;
+        if(!uartRx_line(&uartRx, &line, &length)) continue;
+        u32 lineLength = length;
+        tokenLength = uartRx_token(&line, &length, &token);
+        if(uartRx_tokenIs(token, tokenLength, "add")){
+            u32 sum = 0;
+            while((tokenLength = uartRx_token(&line, &length, &token))){
+                sum += uartRx_tokenValue(token, tokenLength);
+            }
+            bsp_printf("sum = %d \r\n", sum);
+        } else if(tokenLength){
+            bsp_printf("line of %d characters, first token of %d characters \r\n", lineLength, tokenLength);
         }
+        uartRx_release(&uartRx);
     }
 }
 
 
+
@@ -0,0 +1,178 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#include <stdint.h>
+#include "bsp.h"
+#include "plic.h"
+#include "clint.h"
+#include "riscv.h"
+#include "uart.h"
+#include "uartBaud.h"
+#include "uartRx.h"
+
+// Stress test of the interrupt driven receiver (driver/uartRx.h) at the highest baudrate the host accepts.
+// The host (tool/uartRxStress.py) negotiates the baudrate, then streams "<sequence> <payload> <sum>" lines
+// back to back and ends with "END". Each line is checked while the main loop keeps wasting time between
+// lines, so the RX FIFO alone would overflow; the ring buffer has to absorb the bursts.
+
+#define UART_HZ         BSP_CLINT_HZ
+#define DEFAULT_BAUD    SYSTEM_UART_0_IO_PARAMETER_INIT_CONFIG_BAUDRATE
+#define TIMEOUT_US      2000000
+
+// Time spent after each line, and after every SLOW_PERIOD lines, to mimic a busy application
+#define BUSY_US         20
+#define SLOW_US         2000
+#define SLOW_PERIOD     64
+
+const u32 rates[] = {3000000, 2500000, 2000000, 1000000, 921600};
+#define RATE_COUNT (sizeof(rates)/sizeof(rates[0]))
+
+void init();
+void main();
+void trap();
+void crash();
+void trap_entry();
+void UartInterrupt();
+
+UartRx uartRx;
+
+void init(){
+    //configure PLIC
+    //cpu 0 accept all interrupts with priority above 0
+    plic_set_threshold(BSP_PLIC, BSP_PLIC_CPU_0, 0);
+
+    plic_set_enable(BSP_PLIC, BSP_PLIC_CPU_0, SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, 1);
+    plic_set_priority(BSP_PLIC, SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, 1);
+
+    //enable interrupts
+    csr_write(mtvec, trap_entry); //Set the machine trap vector (../common/trap.S)
+    csr_set(mie, MIE_MEIE); //Enable external interrupts
+    csr_write(mstatus, MSTATUS_MPP | MSTATUS_MIE);
+}
+
+//Called by trap_entry on both exceptions and interrupts events
+void trap(){
+    int32_t mcause = csr_read(mcause);
+    //Interrupt if set, exception if cleared
+    int32_t interrupt = mcause < 0;
+    int32_t cause     = mcause & 0xF;
+
+    if(interrupt){
+        switch(cause){
+        case CAUSE_MACHINE_EXTERNAL: UartInterrupt(); break;
+        default: crash(); break;
+        }
+    } else {
+        crash();
+    }
+}
+
+void UartInterrupt()
+{
+    uint32_t claim;
+    //While there is pending interrupts
+    while(claim = plic_claim(BSP_PLIC, BSP_PLIC_CPU_0)){
+        switch(claim){
+        case SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT: uartRx_interrupt(&uartRx); break;
+        default: crash(); break;
+        }
+        //unmask the claimed interrupt
+        plic_release(BSP_PLIC, BSP_PLIC_CPU_0, claim);
+    }
+}
+
+void crash(){
+    bsp_printf("\r\n*** CRASH ***\r\n");
+    while(1);
+}
+
+//Check one "<sequence> <payload> <payload byte sum modulo 256>" line, numbers in decimal
+u32 checkLine(const char *line, u32 length, u32 sequence){
+    const char *token, *payload;
+    u32 tokenLength, payloadLength, sum = 0;
+
+    tokenLength = uartRx_token(&line, &length, &token);
+    if(!tokenLength || uartRx_tokenValue(token, tokenLength) != sequence) return 0;
+    payloadLength = uartRx_token(&line, &length, &payload);
+    for(u32 i = 0;i < payloadLength;i++) sum += (u8)payload[i];
+    tokenLength = uartRx_token(&line, &length, &token);
+    return tokenLength && uartRx_tokenValue(token, tokenLength) == (sum & 0xFF);
+}
+
+void stress(u32 baudrate){
+    u32 lines = 0, errors = 0;
+    u64 start, elapsed;
+
+    uartRx_init(&uartRx, BSP_UART_TERMINAL, 0);
+    bsp_printf("#STRESS %d\r\n", baudrate);
+    start = clint_getTime(BSP_CLINT);
+    while(1){
+        const char *line;
+        u32 length;
+        if(!uartRx_line(&uartRx, &line, &length)) continue;
+        if(uartRx_tokenIs(line, length, "END")){
+            uartRx_release(&uartRx);
+            break;
+        }
+        if(length && !checkLine(line, length, lines)) errors++;
+        if(length) lines++;
+        uartRx_release(&uartRx);
+        clint_uDelay(lines % SLOW_PERIOD ? BUSY_US : SLOW_US, UART_HZ, BSP_CLINT);
+    }
+    elapsed = clint_getTime(BSP_CLINT) - start;
+    uart_RX_NotemptyInterruptEna(BSP_UART_TERMINAL, 0);
+
+    bsp_printf("#RESULT %d %d %d %d %d %d\r\n", lines, errors, uartRx.overflows, uartRx.maxBurst,
+        uartRx.interruptCount, (u32)(elapsed / (UART_HZ/1000)));
+}
+
+void main() {
+    bsp_init();
+    init();
+    bsp_printf("uart rx ring buffer stress demo ! \r\n");
+    bsp_printf("ring buffer of %d bytes, %d us of work per line, %d us every %d lines \r\n",
+        UART_RX_RING_SIZE, BUSY_US, SLOW_US, SLOW_PERIOD);
+
+    while(1){
+        u32 baudrate = uartBaud_negotiate(BSP_UART_TERMINAL, UART_HZ, BSP_CLINT, DEFAULT_BAUD, rates, RATE_COUNT, TIMEOUT_US);
+        if(baudrate != DEFAULT_BAUD){
+            stress(baudrate);
+            uartBaud_apply(BSP_UART_TERMINAL, UART_HZ, DEFAULT_BAUD);
+        }
+        bsp_uDelay(500000);
+    }
+}
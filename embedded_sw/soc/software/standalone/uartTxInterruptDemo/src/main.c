@@ -0,0 +1,195 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+#include <stdint.h>
+#include "plic.h"
+#include "clint.h"
+#include "bsp.h"
+#include "riscv.h"
+#include "uartTx.h"
+
+#define FRAME_WIDTH  80
+#define FRAME_HEIGHT 22
+#define FRAME_SIZE   (FRAME_HEIGHT*(FRAME_WIDTH+2))
+
+void init();
+void main();
+void trap();
+void crash();
+void trap_entry();
+void UartInterrupt();
+
+UartTx uartTx;
+char frame[FRAME_SIZE];
+
+void init(){
+    uartTx_init(&uartTx, BSP_UART_TERMINAL, BSP_CLINT);
+
+    //configure PLIC
+    //cpu 0 accept all interrupts with priority above 0
+    plic_set_threshold(BSP_PLIC, BSP_PLIC_CPU_0, 0);
+
+    //enable SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, the TX FIFO empty interrupt itself is enabled by uartTx_write
+    plic_set_enable(BSP_PLIC, BSP_PLIC_CPU_0, SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, 1);
+    plic_set_priority(BSP_PLIC, SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT, 1);
+
+    //enable interrupts
+    csr_write(mtvec, trap_entry); //Set the machine trap vector (../common/trap.S)
+    csr_set(mie, MIE_MEIE); //Enable external interrupts
+    csr_write(mstatus, MSTATUS_MPP | MSTATUS_MIE);
+}
+
+//Called by trap_entry on both exceptions and interrupts events
+void trap(){
+    int32_t mcause = csr_read(mcause);
+    //Interrupt if set, exception if cleared
+    int32_t interrupt = mcause < 0;
+    int32_t cause     = mcause & 0xF;
+
+    if(interrupt){
+        switch(cause){
+        case CAUSE_MACHINE_EXTERNAL: UartInterrupt(); break;
+        default: crash(); break;
+        }
+    } else {
+        crash();
+    }
+}
+
+void UartInterrupt()
+{
+    uint32_t claim;
+    //While there is pending interrupts
+    while(claim = plic_claim(BSP_PLIC, BSP_PLIC_CPU_0)){
+        switch(claim){
+        case SYSTEM_PLIC_SYSTEM_UART_0_IO_INTERRUPT: uartTx_interrupt(&uartTx); break;
+        default: crash(); break;
+        }
+        //unmask the claimed interrupt
+        plic_release(BSP_PLIC, BSP_PLIC_CPU_0, claim);
+    }
+}
+
+void crash(){
+    uartTx_flush(&uartTx);
+    bsp_printf("\r\n*** CRASH ***\r\n");
+    while(1);
+}
+
+//Fill the frame with a moving pattern, the kind of output a renderer would produce
+void buildFrame(u32 offset){
+    char *p = frame;
+    for(u32 y = 0;y < FRAME_HEIGHT;y++){
+        for(u32 x = 0;x < FRAME_WIDTH;x++){
+            *p++ = ".,-~:;=!*#$@"[(x + y + offset) % 12];
+        }
+        *p++ = '\r';
+        *p++ = '\n';
+    }
+}
+
+//Stand in for the rendering work done while the UART is draining
+u32 busyWork(){
+    u32 acc = 0;
+    while(uartTx_pending(&uartTx)){
+        for(u32 i = 0;i < 1000;i++) acc += i*i;
+    }
+    return acc;
+}
+
+void main() {
+    u32 t0, t1;
+    u32 blockingTicks, queueTicks, drainTicks, isrTicks;
+
+    init();
+    bsp_printf("uart tx interrupt demo ! \r\n");
+
+    //Reference, every byte waits on the UART
+    buildFrame(0);
+    t0 = clint_getTimeLow(BSP_CLINT);
+    for(u32 i = 0;i < FRAME_SIZE;i++) uart_write(BSP_UART_TERMINAL, frame[i]);
+    while(uart_writeAvailability(BSP_UART_TERMINAL) != UART_TX_FIFO_DEPTH);
+    t1 = clint_getTimeLow(BSP_CLINT);
+    blockingTicks = t1 - t0;
+
+    //Same frame through the ring buffer, the CPU is free as soon as uartTx_write returns
+    buildFrame(1);
+    uartTx.interruptTicks = 0;
+    uartTx.interruptCount = 0;
+    t0 = clint_getTimeLow(BSP_CLINT);
+    uartTx_write(&uartTx, frame, FRAME_SIZE);
+    t1 = clint_getTimeLow(BSP_CLINT);
+    queueTicks = t1 - t0;
+    busyWork();
+    uartTx_flush(&uartTx);
+    drainTicks = clint_getTimeLow(BSP_CLINT) - t0;
+    isrTicks = uartTx.interruptTicks;
+
+    bsp_printf("\r\nframe size                    : %d bytes\r\n", FRAME_SIZE);
+    bsp_printf("blocking uart_write           : %d ticks\r\n", blockingTicks);
+    bsp_printf("uartTx_write                  : %d ticks\r\n", queueTicks);
+    bsp_printf("interrupt routine (%d calls)  : %d ticks\r\n", uartTx.interruptCount, isrTicks);
+    bsp_printf("frame on the wire             : %d ticks\r\n", drainTicks);
+    bsp_printf("cpu ticks freed per frame     : %d\r\n", blockingTicks - queueTicks - isrTicks);
+
+    //The print functions can use the ring buffer as output sink, bsp_printf then returns once the text is queued
+    u32 printTicks, sinkTicks;
+    t0 = clint_getTimeLow(BSP_CLINT);
+    bsp_printf("bsp_printf through the default output, frame %d of %d bytes\r\n", 0, FRAME_SIZE);
+    printTicks = clint_getTimeLow(BSP_CLINT) - t0;
+    while(uart_writeAvailability(BSP_UART_TERMINAL) != UART_TX_FIFO_DEPTH);
+    bsp_setOutputSink(uartTx_sink, &uartTx);
+    t0 = clint_getTimeLow(BSP_CLINT);
+    bsp_printf("bsp_printf through the uartTx sink, frame %d of %d bytes\r\n", 1, FRAME_SIZE);
+    sinkTicks = clint_getTimeLow(BSP_CLINT) - t0;
+    uartTx_flush(&uartTx);
+    bsp_setOutputSink(0, 0);
+
+    //Or be formatted in RAM and sent later in one piece
+    char line[64];
+    u32 length = bsp_snprintf(line, sizeof(line), "bsp_printf ticks : default %d, uartTx sink %d\r\n", printTicks, sinkTicks);
+    uartTx_write(&uartTx, line, length < sizeof(line) ? length : sizeof(line) - 1);
+    uartTx_flush(&uartTx);
+
+    //Keep streaming frames, only the copy into the ring buffer costs CPU time
+    for(u32 offset = 2;;offset++){
+        buildFrame(offset);
+        while(uartTx_space(&uartTx) < FRAME_SIZE);
+        uartTx_write(&uartTx, frame, FRAME_SIZE);
+    }
+}
+
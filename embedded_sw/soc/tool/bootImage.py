@@ -0,0 +1,257 @@
+import argparse
+import binascii
+import struct
+import sys
+
+# Packs an application into the boot image loaded by the SPI flash bootloader,
+# see driver/bootImage.h for the format.
+
+BOOT_IMAGE_MAGIC       = 0x474D4942
+BOOT_IMAGE_VERSION     = 3
+BOOT_IMAGE_SEGMENT_MAX = 4
+BOOT_IMAGE_LZ4         = 1 << 0
+
+HEADER_FORMAT  = '<8I'
+SEGMENT_FORMAT = '<4I'
+HEADER_SIZE    = struct.calcsize(HEADER_FORMAT) + BOOT_IMAGE_SEGMENT_MAX * struct.calcsize(SEGMENT_FORMAT)
+
+CRC_OFFSET     = 20 # crc field of the header
+
+USER_SOFTWARE_MEMORY = 0xF9000000
+
+PT_LOAD = 1
+SHT_SYMTAB = 2
+
+MIN_MATCH   = 4
+MAX_OFFSET  = 0xFFFF
+LAST_LITERALS = 5  # The LZ4 block format ends with at least 5 literals
+MF_LIMIT      = 12 # and the last match starts at least 12 bytes before the end
+
+def lz4Length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+def lz4Sequence(out, data, literalStart, literalEnd, offset, match):
+    literals = literalEnd - literalStart
+    token = min(literals, 15) << 4
+    if match:
+        token |= min(match - MIN_MATCH, 15)
+    out.append(token)
+    if literals >= 15:
+        lz4Length(out, literals - 15)
+    out += data[literalStart:literalEnd]
+    if match:
+        out += struct.pack('<H', offset)
+        if match - MIN_MATCH >= 15:
+            lz4Length(out, match - MIN_MATCH - 15)
+
+def lz4Compress(data):
+    # Greedy parsing, the candidates are the last positions of the same 4 bytes
+    out = bytearray()
+    table = {}
+    anchor = 0
+    position = 0
+    limit = len(data) - MF_LIMIT
+    while position < limit:
+        key = data[position:position + MIN_MATCH]
+        best = 0
+        bestOffset = 0
+        for candidate in reversed(table.get(key, [])):
+            offset = position - candidate
+            if offset > MAX_OFFSET:
+                break
+            length = MIN_MATCH
+            end = len(data) - LAST_LITERALS
+            while position + length < end and data[candidate + length] == data[position + length]:
+                length += 1
+            if length > best:
+                best = length
+                bestOffset = offset
+        chain = table.setdefault(key, [])
+        chain.append(position)
+        if len(chain) > 16:
+            del chain[0]
+        if best < MIN_MATCH:
+            position += 1
+            continue
+        lz4Sequence(out, data, anchor, position, bestOffset, best)
+        for skipped in range(position + 1, min(position + best, limit)):
+            chain = table.setdefault(data[skipped:skipped + MIN_MATCH], [])
+            chain.append(skipped)
+            if len(chain) > 16:
+                del chain[0]
+        position += best
+        anchor = position
+    lz4Sequence(out, data, anchor, len(data), 0, 0)
+    return bytes(out)
+
+def lz4Decompress(data, length):
+    # Same checks as bootImage_lz4Stream(), used to validate the packed image
+    out = bytearray()
+    position = 0
+    while position < len(data):
+        token = data[position]
+        position += 1
+        literals = token >> 4
+        if literals == 15:
+            while True:
+                byte = data[position]
+                position += 1
+                literals += byte
+                if byte != 255:
+                    break
+        out += data[position:position + literals]
+        position += literals
+        if position >= len(data):
+            break
+        offset = data[position] | (data[position + 1] << 8)
+        position += 2
+        match = token & 0xF
+        if match == 15:
+            while True:
+                byte = data[position]
+                position += 1
+                match += byte
+                if byte != 255:
+                    break
+        match += MIN_MATCH
+        if offset == 0 or offset > len(out):
+            raise ValueError('match offset out of the image')
+        for i in range(match):
+            out.append(out[-offset])
+    if len(out) != length:
+        raise ValueError('decompressed %d bytes instead of %d' % (len(out), length))
+    return bytes(out)
+
+class Segment:
+    def __init__(self, address, data, size):
+        self.address = address
+        self.data = data
+        self.size = size
+
+def elfSegments(elf):
+    # Loadable segments of a 32 bits little endian ELF, with their size cut at the _end symbol,
+    # so the stack and the heap, which follow the .bss, are neither stored nor zeroed
+    if elf[0:4] != b'\x7fELF' or elf[4] != 1 or elf[5] != 1:
+        raise ValueError('not a 32 bits little endian ELF')
+    entry, phoff, shoff = struct.unpack_from('<3I', elf, 24)
+    phentsize, phnum, shentsize, shnum = struct.unpack_from('<4H', elf, 42)
+    end = None
+    for i in range(shnum):
+        name, type, flags, addr, offset, size, link, info, align, entsize = struct.unpack_from('<10I', elf, shoff + i * shentsize)
+        if type != SHT_SYMTAB:
+            continue
+        strtab = struct.unpack_from('<10I', elf, shoff + link * shentsize)[4]
+        for s in range(offset, offset + size, entsize):
+            nameOffset, value = struct.unpack_from('<2I', elf, s)
+            if elf[strtab + nameOffset:elf.index(b'\0', strtab + nameOffset)] == b'_end':
+                end = value
+    segments = []
+    for i in range(phnum):
+        type, offset, vaddr, paddr, filesz, memsz, flags, align = struct.unpack_from('<8I', elf, phoff + i * phentsize)
+        if type != PT_LOAD or memsz == 0:
+            continue
+        if end is not None and vaddr <= end < vaddr + memsz:
+            memsz = end - vaddr
+        segments.append(Segment(vaddr, elf[offset:offset + min(filesz, memsz)], memsz))
+    return entry, segments
+
+def trimSegment(segment):
+    # The zeroes at the end of the data are left to the bootloader, as the .bss
+    data = segment.data.rstrip(b'\0')
+    data += bytes(-len(data) & 3)
+    segment.data = data
+    segment.size = (segment.size + 3) & ~3
+
+def pack(entry, segments, compress):
+    if not 0 < len(segments) <= BOOT_IMAGE_SEGMENT_MAX:
+        raise ValueError('%d segments, the bootloader supports 1 to %d' % (len(segments), BOOT_IMAGE_SEGMENT_MAX))
+    flags = BOOT_IMAGE_LZ4 if compress else 0
+    table = b''
+    payload = b''
+    length = 0
+    for segment in segments:
+        if segment.address & 3:
+            raise ValueError('segment at 0x%08x is not word aligned' % segment.address)
+        trimSegment(segment)
+        stored = segment.data
+        if compress and segment.data:
+            stored = lz4Compress(segment.data)
+            if lz4Decompress(stored, len(segment.data)) != segment.data:
+                raise ValueError('compression self check failed')
+        table += struct.pack(SEGMENT_FORMAT, segment.address, len(segment.data), len(stored), segment.size)
+        payload += stored
+        length += len(segment.data)
+    table += bytes(HEADER_SIZE - struct.calcsize(HEADER_FORMAT) - len(table))
+    header = struct.pack(HEADER_FORMAT, BOOT_IMAGE_MAGIC, BOOT_IMAGE_VERSION, flags, length, len(payload), 0, entry, len(segments))
+    return stamp(header + table + payload), length
+
+def stamp(image):
+    # The crc covers the header, with the crc field at 0, and the payload
+    magic, version, flags, length, storedLength = struct.unpack_from('<5I', image)
+    if magic != BOOT_IMAGE_MAGIC or version != BOOT_IMAGE_VERSION:
+        raise ValueError('not a version %d boot image' % BOOT_IMAGE_VERSION)
+    if len(image) < HEADER_SIZE + storedLength:
+        raise ValueError('image truncated, %d bytes of payload instead of %d' % (len(image) - HEADER_SIZE, storedLength))
+    image = bytearray(image[:HEADER_SIZE + storedLength])
+    image[CRC_OFFSET:CRC_OFFSET + 4] = bytes(4)
+    crc = binascii.crc32(image) & 0xFFFFFFFF
+    image[CRC_OFFSET:CRC_OFFSET + 4] = struct.pack('<I', crc)
+    return bytes(image)
+
+def parse_args():
+    parser = argparse.ArgumentParser()
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('-e',
+                        '--elf',
+                        help='application ELF, for eg build/apb3Demo.elf')
+    source.add_argument('-b',
+                        '--bin',
+                        help='application binary, for eg build/apb3Demo.bin, loaded and started at --address')
+    source.add_argument('-s',
+                        '--stamp',
+                        help='boot image whose CRC32 is updated in place, after it was patched')
+    parser.add_argument('-a',
+                        '--address',
+                        default=USER_SOFTWARE_MEMORY,
+                        type=lambda x: int(x, 0),
+                        help='load address of the binary given with -b')
+    parser.add_argument('-o',
+                        '--output',
+                        help='boot image to write to the flash at USER_SOFTWARE_FLASH')
+    parser.add_argument('-r',
+                        '--raw',
+                        action='store_true',
+                        help='store the binary without compression')
+    args = parser.parse_args()
+    if not args.stamp and not args.output:
+        parser.error('the boot image to write is required, give it with -o')
+    return args
+
+if __name__ == '__main__':
+    args = parse_args()
+    if args.stamp:
+        with open(args.stamp, 'rb') as f:
+            image = stamp(f.read())
+        with open(args.output or args.stamp, 'wb') as f:
+            f.write(image)
+        print('%s : crc %08x' % (args.output or args.stamp, struct.unpack_from('<I', image, CRC_OFFSET)[0]))
+        sys.exit(0)
+    if args.elf:
+        with open(args.elf, 'rb') as f:
+            entry, segments = elfSegments(f.read())
+    else:
+        with open(args.bin, 'rb') as f:
+            data = f.read()
+        entry = args.address
+        segments = [Segment(args.address, data, len(data))]
+    size = sum(segment.size for segment in segments)
+    image, length = pack(entry, segments, not args.raw)
+    with open(args.output, 'wb') as f:
+        f.write(image)
+    stored = len(image) - HEADER_SIZE
+    print('%s : %d segments, %d bytes in memory, %d to load, %d stored (%d%%), %d bytes to flash' % (
+        args.output, len(segments), size, length, stored, stored * 100 // max(length, 1), len(image)))
+    sys.exit(0)
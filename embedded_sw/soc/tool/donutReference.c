@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+
+// Host build of the donutDemo renderer, prints the reference CRC32 of the headless capture
+// (donutDemo "capture" command or DONUT_HEADLESS=yes build) and checks a capture log.
+// See README-donutReference.txt.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "donut.h"
+#include "crc32.h"
+
+#define CAPTURE_FRAMES  256
+
+static Donut_Geometry geometry;
+static Donut_Config config;
+static Donut_Transform transform;
+static char frame[DONUT_SIZE];
+static s32 zBuffer[DONUT_SIZE];
+static u32 frameCrc[CAPTURE_FRAMES];
+
+// The target merges the tiles of all its harts, which gives the same frame as a single pass
+static void render(u32 index){
+    donut_clear(frame);
+    memset(zBuffer, 0, sizeof(zBuffer));
+    donut_transformInit(&transform, &geometry, &config, index*DONUT_A_STEP, index*DONUT_B_STEP);
+    donut_renderCachedSlice(frame, zBuffer, &geometry, &config, &transform, 0, config.thetaCount);
+}
+
+// Compare the capture log of the target with the reference, returns the number of mismatches
+static u32 check(FILE *log, u32 frames, u32 digest){
+    char line[256];
+    u32 errors = 0, checked = 0, index, crc, count;
+    while(fgets(line, sizeof(line), log)){
+        if(sscanf(line, "frame %u crc %x", &index, &crc) == 2){
+            if(index >= frames || index >= CAPTURE_FRAMES){
+                printf("frame %u isn't in the reference, run it with -n %u\n", index, index + 1);
+                errors++;
+            } else if(crc != frameCrc[index]){
+                printf("frame %u differs : crc %08x, reference %08x\n", index, crc, frameCrc[index]);
+                errors++;
+            }
+            checked++;
+        } else if(sscanf(line, "#CAPTURE frames %u digest %x", &count, &crc) == 2){
+            if(count != frames){
+                printf("the target captured %u frames, the reference %u\n", count, frames);
+                errors++;
+            } else if(crc != digest){
+                printf("digest differs : %08x, reference %08x\n", crc, digest);
+                errors++;
+            }
+            checked++;
+        }
+    }
+    if(!checked){
+        printf("no capture found in the log\n");
+        errors++;
+    }
+    printf("%u lines checked, %u mismatches\n", checked, errors);
+    return errors;
+}
+
+int main(int argc, char **argv){
+    u32 frames = CAPTURE_FRAMES;
+    const char *logPath = NULL;
+    u32 valid = 1;
+    // Same settings as the size, step and ramp console commands of donutDemo
+    donut_configInit(&config);
+    for(int i = 1;i < argc && valid;i++){
+        if(!strcmp(argv[i], "-n") && i + 1 < argc){
+            frames = strtoul(argv[++i], NULL, 0);
+        } else if(!strcmp(argv[i], "-s") && i + 2 < argc){
+            valid = donut_configSize(&config, strtoul(argv[i+1], NULL, 0), strtoul(argv[i+2], NULL, 0));
+            i += 2;
+        } else if(!strcmp(argv[i], "-t") && i + 2 < argc){
+            valid = donut_configSteps(&config, strtoul(argv[i+1], NULL, 0), strtoul(argv[i+2], NULL, 0));
+            i += 2;
+        } else if(!strcmp(argv[i], "-r") && i + 1 < argc){
+            valid = donut_configRamp(&config, argv[i+1], strlen(argv[i+1]));
+            i += 1;
+        } else if(argv[i][0] != '-' && !logPath){
+            logPath = argv[i];
+        } else {
+            valid = 0;
+        }
+    }
+    if(!valid){
+        printf("usage : %s [-n <frames>] [-s <width> <height>] [-t <theta step> <phi step>] [-r <ramp>] [capture log]\n", argv[0]);
+        return 2;
+    }
+    if(!frames) frames = CAPTURE_FRAMES;
+
+    donut_init();
+    donut_geometryInit(&geometry, &config);
+    u32 digest = CRC32_INIT;
+    clock_t start = clock();
+    for(u32 i = 0;i < frames;i++){
+        render(i);
+        if(i < CAPTURE_FRAMES) frameCrc[i] = crc32(frame, DONUT_SIZE);
+        digest = crc32_update(digest, frame, DONUT_SIZE);
+    }
+    double seconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+    digest = crc32_final(digest);
+
+    if(logPath){
+        FILE *log = fopen(logPath, "r");
+        if(!log){
+            printf("can't open %s\n", logPath);
+            return 2;
+        }
+        u32 errors = check(log, frames, digest);
+        fclose(log);
+        return errors ? 1 : 0;
+    }
+    for(u32 i = 0;i < frames && i < CAPTURE_FRAMES;i++){
+        printf("frame %u crc %08x\n", i, frameCrc[i]);
+    }
+    printf("#CAPTURE frames %u digest %08x host fps %.2f\n", frames, digest, seconds > 0 ? frames/seconds : 0.0);
+    return 0;
+}
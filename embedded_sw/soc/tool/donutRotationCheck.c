@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+
+// Host check of the Donut_Rotation sine/cosine pairs of donutDemo against libm, for the sample
+// and the frame steps. See README-donutRotationCheck.txt.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "donut.h"
+
+#define STEPS       1000000
+#define ERROR_MAX   1.7e-6 // Largest error accepted on the sine and on the cosine
+
+static const struct {
+    const char *name;
+    u32 step;
+} rotations[] = {
+    {"theta", DONUT_THETA_STEP},
+    {"phi", DONUT_PHI_STEP},
+    {"A", DONUT_A_STEP},
+    {"B", DONUT_B_STEP},
+};
+
+// Largest error of a rotation over the given number of steps, against sin/cos in double of the exact angle
+static double check(u32 step, u32 steps, double *norm){
+    Donut_Rotation rotation;
+    double error = 0;
+    *norm = 0;
+    donut_rotationInit(&rotation, 0, step);
+    for(u32 i = 1;i <= steps;i++){
+        donut_rotationAdvance(&rotation);
+        double angle = 2*M_PI*(double)((u64)i*step % DONUT_ANGLE_TURN)/DONUT_ANGLE_TURN;
+        error = fmax(error, fabs(rotation.sin - sin(angle)));
+        error = fmax(error, fabs(rotation.cos - cos(angle)));
+        *norm = fmax(*norm, fabs(hypot(rotation.sin, rotation.cos) - 1));
+    }
+    return error;
+}
+
+int main(int argc, char **argv){
+    u32 steps = STEPS;
+    if(argc == 3 && !strcmp(argv[1], "-n")){
+        steps = strtoul(argv[2], NULL, 0);
+    } else if(argc != 1){
+        printf("usage : %s [-n <steps>]\n", argv[0]);
+        return 2;
+    }
+
+    u32 errors = 0;
+    for(u32 i = 0;i < sizeof(rotations)/sizeof(rotations[0]);i++){
+        double norm;
+        double error = check(rotations[i].step, steps, &norm);
+        u32 pass = error <= ERROR_MAX;
+        printf("%-5s step %3u : %u steps, max error %.3g, max norm error %.3g %s\n", rotations[i].name,
+            rotations[i].step, steps, error, norm, pass ? "PASS" : "FAIL");
+        if(!pass) errors++;
+    }
+    return errors ? 1 : 0;
+}
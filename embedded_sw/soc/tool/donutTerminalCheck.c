@@ -0,0 +1,229 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+
+// Golden test of the donutDemo terminal encoding : replays the donutEncode.h byte stream
+// through a model of the terminal and checks that the screen shows every frame.
+// See README-donutTerminalCheck.txt.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "donut.h"
+#include "donutEncode.h"
+
+#define CHECK_FRAMES    2000
+#define TERMINAL_ROWS   24
+#define COLUMNS_MAX     256
+
+static Donut_Geometry geometry;
+static Donut_Config config;
+static Donut_Transform transform;
+static Donut_Encoder encoder;
+static char frame[DONUT_SIZE];
+static s32 zBuffer[DONUT_SIZE];
+static char stream[DONUT_ENCODE_FULL];
+
+// VT100 subset used by donutEncode.h : CUP, CUF, CR, LF and the pending wrap of the last column
+typedef struct {
+    char screen[TERMINAL_ROWS][COLUMNS_MAX];
+    u32 columns;
+    u32 row, column;
+    u32 wrapPending;
+    u32 errors; // Bytes the model doesn't know
+} Terminal;
+
+static Terminal terminal;
+
+static void terminal_lineFeed(Terminal *t){
+    if(t->row + 1 < TERMINAL_ROWS){
+        t->row++;
+        return;
+    }
+    memmove(t->screen[0], t->screen[1], (TERMINAL_ROWS - 1)*COLUMNS_MAX);
+    memset(t->screen[TERMINAL_ROWS - 1], ' ', COLUMNS_MAX);
+}
+
+// Parameters are 1 based, 0 or missing means 1, the cursor is clamped to the screen
+static u32 terminal_parameter(u32 value, u32 max){
+    if(value == 0) value = 1;
+    return value > max ? max - 1 : value - 1;
+}
+
+static void terminal_write(Terminal *t, const char *data, u32 length){
+    for(u32 i = 0;i < length;i++){
+        char c = data[i];
+        if(c == '\x1b'){
+            u32 parameters[2] = {0, 0}, count = 0;
+            if(++i >= length || data[i] != '['){
+                t->errors++;
+                continue;
+            }
+            while(++i < length && ((data[i] >= '0' && data[i] <= '9') || data[i] == ';')){
+                if(data[i] == ';'){
+                    if(++count == 2) break;
+                } else {
+                    parameters[count] = parameters[count]*10 + data[i] - '0';
+                }
+            }
+            if(i >= length){
+                t->errors++;
+                continue;
+            }
+            if(data[i] == 'H'){
+                t->row = terminal_parameter(parameters[0], TERMINAL_ROWS);
+                t->column = terminal_parameter(parameters[1], t->columns);
+            } else if(data[i] == 'C' && count == 0){
+                t->column += parameters[0] ? parameters[0] : 1;
+                if(t->column >= t->columns) t->column = t->columns - 1;
+            } else {
+                t->errors++;
+            }
+            t->wrapPending = 0;
+        } else if(c == '\r'){
+            t->column = 0;
+            t->wrapPending = 0;
+        } else if(c == '\n'){
+            terminal_lineFeed(t);
+            t->wrapPending = 0;
+        } else if(c >= ' ' && c <= '~'){
+            // Writing the last column leaves the cursor on it, the next character wraps first
+            if(t->wrapPending){
+                t->column = 0;
+                terminal_lineFeed(t);
+                t->wrapPending = 0;
+            }
+            t->screen[t->row][t->column] = c;
+            if(t->column + 1 == t->columns) t->wrapPending = 1;
+            else t->column++;
+        } else {
+            t->errors++;
+        }
+    }
+}
+
+// Same renderer as the target, see donutReference.c
+static void render(u32 index){
+    donut_clear(frame);
+    memset(zBuffer, 0, sizeof(zBuffer));
+    donut_transformInit(&transform, &geometry, &config, index*DONUT_A_STEP, index*DONUT_B_STEP);
+    donut_renderCachedSlice(frame, zBuffer, &geometry, &config, &transform, 0, config.thetaCount);
+}
+
+// The donut never reaches the last column, these frames change random cells of the previous one
+static u32 randomState = 1;
+
+static void randomFrame(u32 index){
+    u32 changes = 1 + index % (DONUT_SIZE/4);
+    for(u32 i = 0;i < changes;i++){
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        frame[randomState % DONUT_SIZE] = DONUT_RAMP[(randomState >> 16) % (sizeof(DONUT_RAMP) - 1)];
+    }
+}
+
+// Number of cells of the screen which differ from the frame
+static u32 compare(){
+    u32 cells = 0;
+    for(u32 y = 0;y < DONUT_HEIGHT;y++){
+        for(u32 x = 0;x < terminal.columns;x++){
+            char expected = x < DONUT_WIDTH ? frame[y*DONUT_WIDTH + x] : ' ';
+            if(terminal.screen[y][x] != expected) cells++;
+        }
+    }
+    for(u32 y = DONUT_HEIGHT;y < TERMINAL_ROWS;y++){
+        for(u32 x = 0;x < terminal.columns;x++){
+            if(terminal.screen[y][x] != ' ') cells++;
+        }
+    }
+    return cells;
+}
+
+int main(int argc, char **argv){
+    u32 frames = CHECK_FRAMES;
+    u32 columns = DONUT_WIDTH;
+    u32 full = 0;
+    u32 valid = 1;
+    for(int i = 1;i < argc && valid;i++){
+        if(!strcmp(argv[i], "-n") && i + 1 < argc){
+            frames = strtoul(argv[++i], NULL, 0);
+        } else if(!strcmp(argv[i], "-w") && i + 1 < argc){
+            columns = strtoul(argv[++i], NULL, 0);
+            valid = columns >= DONUT_WIDTH && columns <= COLUMNS_MAX;
+        } else if(!strcmp(argv[i], "-f")){
+            full = 1;
+        } else {
+            valid = 0;
+        }
+    }
+    if(!valid){
+        printf("usage : %s [-n <frames>] [-w <terminal columns>] [-f]\n", argv[0]);
+        return 2;
+    }
+
+    // The demo clears the terminal, then starts from a full repaint
+    memset(terminal.screen, ' ', sizeof(terminal.screen));
+    terminal.columns = columns;
+    donut_encoderReset(&encoder);
+    donut_configInit(&config);
+    donut_init();
+    donut_geometryInit(&geometry, &config);
+
+    u32 errors = 0;
+    u64 bytes = 0;
+    for(u32 i = 0;i < 2*frames;i++){
+        if(i < frames) render(i);
+        else randomFrame(i - frames);
+        u32 length = full ? donut_encodeFull(&encoder, frame, stream) : donut_encodeDelta(&encoder, frame, stream);
+        if(length > DONUT_ENCODE_FULL){
+            printf("frame %u : %u bytes, more than a full repaint\n", i, length);
+            errors++;
+        }
+        terminal_write(&terminal, stream, length);
+        u32 cells = compare();
+        if(cells || terminal.errors){
+            if(errors < 16) printf("frame %u : %u cells differ, %u unknown bytes\n", i, cells, terminal.errors);
+            terminal.errors = 0;
+            errors++;
+        }
+        bytes += length;
+    }
+    printf("%u donut and %u random frames, %u columns, %u mismatches, %u bytes per frame (full repaint %u)\n",
+        frames, frames, columns, errors, frames ? (u32)(bytes/(2*frames)) : 0, DONUT_ENCODE_FULL);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+
+// Host viewer of the donutDemo compressed output ("output compressed" console command).
+// Splits the compressed frames from the text console output, decodes them with the same
+// donutCompress.h as the target and draws them on the terminal. Lines typed on stdin are sent
+// to the target as console commands. See README-donutViewer.txt.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/select.h>
+#include "donutCompress.h"
+
+static const struct {
+    u32 baudrate;
+    speed_t speed;
+} speeds[] = {
+    {9600, B9600}, {19200, B19200}, {38400, B38400}, {57600, B57600}, {115200, B115200},
+    {230400, B230400}, {460800, B460800}, {921600, B921600}, {1000000, B1000000},
+    {1500000, B1500000}, {2000000, B2000000}, {3000000, B3000000}
+};
+
+static Donut_Decompressor decompressor;
+static u8 encoded[DONUT_COMPRESS_MAX];
+static u32 encodedLength, inFrame, received, overflows, drawnWidth, drawnHeight, quiet;
+static unsigned long long frameBytes;
+static volatile sig_atomic_t stop;
+
+static void onSignal(int signal){
+    stop = 1;
+}
+
+static int openPort(const char *path, u32 baudrate){
+    speed_t speed = 0;
+    for(u32 i = 0;i < sizeof(speeds)/sizeof(speeds[0]);i++){
+        if(speeds[i].baudrate == baudrate) speed = speeds[i].speed;
+    }
+    if(!speed){
+        printf("unsupported baudrate %u\n", baudrate);
+        return -1;
+    }
+    int fd = open(path, O_RDWR | O_NOCTTY);
+    if(fd < 0){
+        printf("can't open %s\n", path);
+        return -1;
+    }
+    struct termios tty;
+    tcgetattr(fd, &tty);
+    cfmakeraw(&tty);
+    cfsetispeed(&tty, speed);
+    cfsetospeed(&tty, speed);
+    tty.c_cflag |= CLOCAL | CREAD;
+    tty.c_cc[VMIN] = 0;
+    tty.c_cc[VTIME] = 1;
+    tcsetattr(fd, TCSANOW, &tty);
+    return fd;
+}
+
+static void draw(){
+    const Donut_Decompressor *d = &decompressor;
+    if(quiet) return;
+    // The size changed, clear what the previous frames left around
+    if(d->width != drawnWidth || d->height != drawnHeight) fputs("\x1b[2J", stdout);
+    drawnWidth = d->width;
+    drawnHeight = d->height;
+    fputs("\x1b[H", stdout);
+    for(u32 y = 0;y < d->height;y++){
+        fwrite(d->frame + y*DONUT_WIDTH, 1, d->width, stdout);
+        fputs("\x1b[K\r\n", stdout);
+    }
+}
+
+// Same framing as tool/telemetryDemux.py, the bytes outside of the frames are console text
+static void feed(const u8 *data, u32 length){
+    for(u32 i = 0;i < length;i++){
+        u8 byte = data[i];
+        if(byte == 0){
+            if(inFrame && encodedLength){
+                frameBytes += encodedLength + 2;
+                received++;
+                if(donut_decompress(&decompressor, encoded, encodedLength)) draw();
+                inFrame = 0;
+            } else {
+                inFrame = 1;
+            }
+            encodedLength = 0;
+        } else if(inFrame){
+            if(encodedLength == sizeof(encoded)){
+                // Too long for a frame, the opening delimiter was lost
+                overflows++;
+                inFrame = 0;
+                encodedLength = 0;
+                continue;
+            }
+            encoded[encodedLength++] = byte;
+        } else if(!quiet){
+            putchar(byte);
+        }
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char **argv){
+    const char *portPath = NULL, *inputPath = NULL;
+    u32 baudrate = 115200;
+    u32 valid = 1;
+    for(int i = 1;i < argc && valid;i++){
+        if(!strcmp(argv[i], "-p") && i + 1 < argc) portPath = argv[++i];
+        else if(!strcmp(argv[i], "-b") && i + 1 < argc) baudrate = strtoul(argv[++i], NULL, 0);
+        else if(!strcmp(argv[i], "-i") && i + 1 < argc) inputPath = argv[++i];
+        else if(!strcmp(argv[i], "-q")) quiet = 1;
+        else valid = 0;
+    }
+    if(!valid || !portPath == !inputPath){
+        printf("usage : %s -p <serial port> [-b <baudrate>] [-q]\n", argv[0]);
+        printf("        %s -i <raw capture file> [-q]\n", argv[0]);
+        return 2;
+    }
+
+    donut_decompressInit(&decompressor);
+    signal(SIGINT, onSignal);
+    u8 buffer[4096];
+    if(inputPath){
+        FILE *input = fopen(inputPath, "rb");
+        if(!input){
+            printf("can't open %s\n", inputPath);
+            return 2;
+        }
+        size_t length;
+        while(!stop && (length = fread(buffer, 1, sizeof(buffer), input))) feed(buffer, length);
+        fclose(input);
+    } else {
+        int port = openPort(portPath, baudrate);
+        if(port < 0) return 2;
+        while(!stop){
+            fd_set fds;
+            FD_ZERO(&fds);
+            FD_SET(port, &fds);
+            FD_SET(STDIN_FILENO, &fds);
+            if(select(port + 1, &fds, NULL, NULL, NULL) < 0) break;
+            if(FD_ISSET(port, &fds)){
+                ssize_t length = read(port, buffer, sizeof(buffer));
+                if(length > 0) feed(buffer, length);
+            }
+            if(FD_ISSET(STDIN_FILENO, &fds)){
+                // Console command, the target takes \r as the end of line
+                ssize_t length = read(STDIN_FILENO, buffer, sizeof(buffer) - 1);
+                if(length <= 0) break;
+                for(ssize_t i = 0;i < length;i++) if(buffer[i] == '\n') buffer[i] = '\r';
+                if(write(port, buffer, length) != length) break;
+            }
+        }
+        close(port);
+    }
+
+    u32 frames = decompressor.keyFrames + decompressor.deltaFrames;
+    printf("\n%u frames received, %llu bytes per frame, %u decoded (%u key, %u delta), %u bad frames, %u frames lost, %u overflows\n",
+        received, received ? frameBytes/received : 0, frames, decompressor.keyFrames, decompressor.deltaFrames,
+        decompressor.errors, decompressor.lost, overflows);
+    return decompressor.errors || overflows ? 1 : 0;
+}
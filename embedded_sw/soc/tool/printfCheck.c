@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+// Copyright (C) 2013-2023 Efinix Inc. All rights reserved.
+//
+// This   document  contains  proprietary information  which   is
+// protected by  copyright. All rights  are reserved.  This notice
+// refers to original work by Efinix, Inc. which may be derivitive
+// of other work distributed under license of the authors.  In the
+// case of derivative work, nothing in this notice overrides the
+// original author's license agreement.  Where applicable, the
+// original license agreement is included in it's original
+// unmodified form immediately below this header.
+//
+// WARRANTY DISCLAIMER.
+//     THE  DESIGN, CODE, OR INFORMATION ARE PROVIDED “AS IS” AND
+//     EFINIX MAKES NO WARRANTIES, EXPRESS OR IMPLIED WITH
+//     RESPECT THERETO, AND EXPRESSLY DISCLAIMS ANY IMPLIED WARRANTIES,
+//     INCLUDING, WITHOUT LIMITATION, THE IMPLIED WARRANTIES OF
+//     MERCHANTABILITY, NON-INFRINGEMENT AND FITNESS FOR A PARTICULAR
+//     PURPOSE.  SOME STATES DO NOT ALLOW EXCLUSIONS OF AN IMPLIED
+//     WARRANTY, SO THIS DISCLAIMER MAY NOT APPLY TO LICENSEE.
+//
+// LIMITATION OF LIABILITY.
+//     NOTWITHSTANDING ANYTHING TO THE CONTRARY, EXCEPT FOR BODILY
+//     INJURY, EFINIX SHALL NOT BE LIABLE WITH RESPECT TO ANY SUBJECT
+//     MATTER OF THIS AGREEMENT UNDER TORT, CONTRACT, STRICT LIABILITY
+//     OR ANY OTHER LEGAL OR EQUITABLE THEORY (I) FOR ANY INDIRECT,
+//     SPECIAL, INCIDENTAL, EXEMPLARY OR CONSEQUENTIAL DAMAGES OF ANY
+//     CHARACTER INCLUDING, WITHOUT LIMITATION, DAMAGES FOR LOSS OF
+//     GOODWILL, DATA OR PROFIT, WORK STOPPAGE, OR COMPUTER FAILURE OR
+//     MALFUNCTION, OR IN ANY EVENT (II) FOR ANY AMOUNT IN EXCESS, IN
+//     THE AGGREGATE, OF THE FEE PAID BY LICENSEE TO EFINIX HEREUNDER
+//     (OR, IF THE FEE HAS BEEN WAIVED, $100), EVEN IF EFINIX SHALL HAVE
+//     BEEN INFORMED OF THE POSSIBILITY OF SUCH DAMAGES.  SOME STATES DO
+//     NOT ALLOW THE EXCLUSION OR LIMITATION OF INCIDENTAL OR
+//     CONSEQUENTIAL DAMAGES, SO THIS LIMITATION AND EXCLUSION MAY NOT
+//     APPLY TO LICENSEE.
+//
+
+// Host build of the bsp_printf formatting, compares bsp_snprintf with the snprintf of the C
+// library for %d, %x, %X and %f. See README-printfCheck.txt.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "bsp.h"
+
+#define REPORT_MAX  16
+
+static u64 checked;
+static u32 errors, ties, nearTies;
+
+static void mismatch(const char *format, u32 bits, const char *bsp, const char *libc){
+    if(errors < REPORT_MAX) printf("%s 0x%08x : bsp \"%s\", libc \"%s\"\n", format, bits, bsp, libc);
+    errors++;
+}
+
+static void checkInteger(u32 bits){
+    char bsp[32], libc[32];
+    bsp_snprintf(bsp, sizeof(bsp), "%d", (int)bits);
+    snprintf(libc, sizeof(libc), "%d", (int)bits);
+    if(strcmp(bsp, libc)) mismatch("%d", bits, bsp, libc);
+    bsp_snprintf(bsp, sizeof(bsp), "%x", bits);
+    snprintf(libc, sizeof(libc), "%08x", bits);
+    if(strcmp(bsp, libc)) mismatch("%x", bits, bsp, libc);
+    bsp_snprintf(bsp, sizeof(bsp), "%X", bits);
+    snprintf(libc, sizeof(libc), "%08X", bits);
+    if(strcmp(bsp, libc)) mismatch("%X", bits, bsp, libc);
+    checked++;
+}
+
+// The float arguments of the target are promoted to double, every float bit pattern is a
+// possible input. bsp_printf prints 4 decimals, the C library rounds the exact binary value
+// half to even, bsp rounds the fraction scaled by 10000 in double half up.
+static void checkFloat(u32 bits){
+    char bsp[32], libc[32];
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    double n = f;
+    if(n != n || fabs(n) >= 4294967295.0) return; // "nan" and the clamp aren't libc behaviours
+    bsp_snprintf(bsp, sizeof(bsp), "%f", n);
+    snprintf(libc, sizeof(libc), "%.4f", n);
+    checked++;
+    if(!strcmp(bsp, libc) || (n == 0 && !strcmp(libc, "-0.0000") && !strcmp(bsp, "0.0000"))) return;
+    double a = fabs(n);
+    double scaled = (a - floor(a)) * 10000.0;
+    double exact = fma(a - floor(a), 10000.0, -scaled);
+    if(exact == 0 && scaled - floor(scaled) == 0.5){
+        ties++; // half up instead of half to even
+    } else if(fabs(scaled - floor(scaled) - 0.5) <= 2.0 * ldexp(1.0, ilogb(scaled) - 52)){
+        nearTies++; // within the rounding of the product by 10000
+    } else {
+        mismatch("%f", bits, bsp, libc);
+    }
+}
+
+// bsp_snprintf truncates like snprintf : size - 1 characters, null terminated, returns the full length
+static void checkTruncation(){
+    char bsp[32], libc[32];
+    for(u32 size = 0;size <= 24;size++){
+        memset(bsp, 'x', sizeof(bsp));
+        memset(libc, 'x', sizeof(libc));
+        int bspLength = bsp_snprintf(bsp, size, "%s=%d %c%x", "value", -123456, '#', 0xCAFEu);
+        int libcLength = snprintf(libc, size, "%s=%d %c%08x", "value", -123456, '#', 0xCAFEu);
+        if(bspLength != libcLength || memcmp(bsp, libc, sizeof(bsp))){
+            if(errors < REPORT_MAX) printf("truncation to %u : bsp %d \"%.*s\", libc %d \"%.*s\"\n",
+                size, bspLength, (int)size, bsp, libcLength, (int)size, libc);
+            errors++;
+        }
+        checked++;
+    }
+}
+
+int main(int argc, char **argv){
+    u32 stride = 257;
+    u32 valid = 1;
+    for(int i = 1;i < argc && valid;i++){
+        if(!strcmp(argv[i], "-a")){
+            stride = 1;
+        } else if(!strcmp(argv[i], "-s") && i + 1 < argc){
+            stride = strtoul(argv[++i], NULL, 0);
+            valid = stride != 0;
+        } else {
+            valid = 0;
+        }
+    }
+    if(!valid){
+        printf("usage : %s [-a] [-s <stride>]\n", argv[0]);
+        return 2;
+    }
+
+    checkTruncation();
+    printf("truncation : %llu checks, %u mismatches\n", (unsigned long long)checked, errors);
+
+    // Every stride-th value, and the values around each power of ten and the limits
+    checked = errors = 0;
+    for(u64 bits = 0;bits <= 0xFFFFFFFFu;bits += stride) checkInteger(bits);
+    for(u32 power = 1;power && power <= 1000000000u;power *= 10){
+        for(int delta = -1;delta <= 1;delta++){
+            checkInteger(power + delta);
+            checkInteger(-(power + delta));
+        }
+    }
+    checkInteger(0x7FFFFFFF);
+    checkInteger(0x80000000);
+    printf("%%d %%x %%X : %llu values, %u mismatches\n", (unsigned long long)checked, errors);
+    u32 integerErrors = errors;
+
+    checked = errors = 0;
+    for(u64 bits = 0;bits <= 0xFFFFFFFFu;bits += stride) checkFloat(bits);
+    printf("%%f : %llu values, %u mismatches, %u ties rounded half up, %u within the rounding of the scaling\n",
+        (unsigned long long)checked, errors, ties, nearTies);
+    return integerErrors || errors ? 1 : 0;
+}
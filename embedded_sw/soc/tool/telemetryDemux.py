@@ -0,0 +1,166 @@
+import argparse
+import struct
+import sys
+import time
+
+try:
+    import serial
+except ImportError:
+    print('pyserial is required, install it with "pip install pyserial".')
+    quit()
+
+# Host side of the telemetry channel, see driver/telemetry.h for the frame format.
+# The text console is printed as it is, the telemetry frames are decoded and printed
+# as records, or written to a log file.
+
+COUNTER = 0x01
+HISTOGRAM = 0x02
+FRAME_TIMING = 0x03
+ACK = 0x04
+COMMAND = 0x80
+
+COMMANDS = {'reset': 1, 'period': 2, 'histogram': 3}
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for i in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+def cobsEncode(data):
+    out = bytearray([0])
+    code = 0
+    run = 1
+    for byte in data:
+        if byte:
+            out.append(byte)
+            run += 1
+            if run == 0xFF:
+                out[code] = run
+                code = len(out)
+                out.append(0)
+                run = 1
+        else:
+            out[code] = run
+            code = len(out)
+            out.append(0)
+            run = 1
+    out[code] = run
+    return bytes(out)
+
+def cobsDecode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            return None
+        out += data[i + 1:i + code]
+        i += code
+        if code != 0xFF and i != len(data):
+            out.append(0)
+    return bytes(out)
+
+def frame(type, sequence, record):
+    content = bytes([type, sequence & 0xFF]) + record
+    content += struct.pack('<H', crc16(content))
+    return b'\0' + cobsEncode(content) + b'\0'
+
+def decodeRecord(type, sequence, record):
+    if type == COUNTER and len(record) == 8:
+        id, reserved, value = struct.unpack('<HHI', record)
+        return 'counter id=%d value=%d' % (id, value)
+    if type == HISTOGRAM and len(record) >= 8:
+        id, binCount, binWidth = struct.unpack_from('<HHI', record)
+        bins = struct.unpack_from('<%dI' % binCount, record, 8)
+        return 'histogram id=%d binWidth=%d bins=%s' % (id, binWidth, ','.join(str(b) for b in bins))
+    if type == FRAME_TIMING and len(record) == 16:
+        return 'frame=%d render=%d transmit=%d bytes=%d' % struct.unpack('<IIII', record)
+    if type == ACK and len(record) == 8:
+        command, status = struct.unpack('<B3xI', record)
+        return 'ack command=%d status=%d' % (command, status)
+    return 'type=0x%02x %s' % (type, record.hex())
+
+class Demux:
+    def __init__(self, text, records):
+        self.text = text
+        self.records = records
+        self.inFrame = False
+        self.encoded = bytearray()
+        self.lastSequence = None
+        self.errors = 0
+        self.lost = 0
+
+    def frameEnd(self):
+        content = cobsDecode(bytes(self.encoded))
+        if content is None or len(content) < 4 or crc16(content[:-2]) != struct.unpack('<H', content[-2:])[0]:
+            self.errors += 1
+            self.records.write('# bad frame\n')
+            return
+        type, sequence = content[0], content[1]
+        if self.lastSequence is not None and sequence != (self.lastSequence + 1) & 0xFF:
+            self.lost += (sequence - self.lastSequence - 1) & 0xFF
+        self.lastSequence = sequence
+        self.records.write('%.3f seq=%d %s\n' % (time.time(), sequence, decodeRecord(type, sequence, content[2:-2])))
+        self.records.flush()
+
+    def feed(self, data):
+        for byte in data:
+            if byte == 0:
+                if self.inFrame and self.encoded:
+                    self.frameEnd()
+                    self.inFrame = False
+                else:
+                    self.inFrame = True
+                self.encoded = bytearray()
+            elif self.inFrame:
+                self.encoded.append(byte)
+            else:
+                self.text.write(chr(byte))
+        self.text.flush()
+
+def parseCommand(text):
+    name, _, argument = text.partition('=')
+    if name not in COMMANDS:
+        raise argparse.ArgumentTypeError('unknown command %s, expected one of %s' % (name, ', '.join(COMMANDS)))
+    return COMMANDS[name], int(argument or '0', 0)
+
+def parse_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-p',
+                        '--port',
+                        required=True,
+                        help='serial port, for eg /dev/ttyUSB1 or COM5')
+    parser.add_argument('-b',
+                        '--baudrate',
+                        default=115200,
+                        type=int,
+                        help='baudrate of the serial port')
+    parser.add_argument('-o',
+                        '--output',
+                        help='file receiving the decoded records, printed with the text by default')
+    parser.add_argument('-c',
+                        '--command',
+                        action='append',
+                        default=[],
+                        type=parseCommand,
+                        help='command sent to the target at startup, reset, period=<frames> or histogram')
+    return parser.parse_args()
+
+if __name__ == '__main__':
+    args = parse_args()
+    port = serial.Serial(args.port, args.baudrate, timeout=0.05)
+    records = open(args.output, 'w') if args.output else sys.stdout
+    demux = Demux(sys.stdout, records)
+    for sequence, (command, argument) in enumerate(args.command):
+        port.write(frame(COMMAND, sequence, struct.pack('<B3xI', command, argument)))
+    try:
+        while True:
+            demux.feed(port.read(256))
+    except KeyboardInterrupt:
+        pass
+    print('\n%d bad frames, %d frames lost' % (demux.errors, demux.lost))
+    port.close()
@@ -0,0 +1,184 @@
+import argparse
+import re
+import struct
+import sys
+
+# Host side of bsp_printf_token, see app/print_token.h for the frame format.
+# The format strings are read from the .bsp_token section of the application ELF,
+# %s arguments are resolved from the sections loaded on the target.
+
+TOKEN_SYNC = 0x1E
+TOKEN_SECTION = '.bsp_token'
+SHF_ALLOC = 0x2
+SHT_PROGBITS = 1
+
+SPECIFIER = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z)?([diuxXcsfFeEgGpo%])')
+
+class Elf:
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            data = f.read()
+        if data[:4] != b'\x7fELF' or data[4] != 1 or data[5] != 1:
+            raise ValueError('%s is not a 32-bit little endian ELF' % path)
+        shoff, = struct.unpack_from('<I', data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from('<HHH', data, 0x2E)
+        sections = []
+        for i in range(shnum):
+            name, type, flags, addr, offset, size = struct.unpack_from('<IIIIII', data, shoff + i * shentsize)
+            sections.append((name, type, flags, addr, data[offset:offset + size]))
+        names = sections[shstrndx][4]
+        self.tokens = b''
+        self.memory = []
+        for name, type, flags, addr, content in sections:
+            name = names[name:names.index(b'\0', name)].decode()
+            if name == TOKEN_SECTION:
+                self.tokens = content
+            elif type == SHT_PROGBITS and flags & SHF_ALLOC:
+                self.memory.append((addr, content))
+
+    def token(self, offset):
+        if offset >= len(self.tokens):
+            return None
+        return self.tokens[offset:self.tokens.index(b'\0', offset)].decode('ascii', 'replace')
+
+    def string(self, address):
+        for base, content in self.memory:
+            if base <= address < base + len(content):
+                offset = address - base
+                return content[offset:content.index(b'\0', offset)].decode('ascii', 'replace')
+        return '<0x%08x>' % address
+
+def signed(word):
+    return word - (1 << 32) if word & 0x80000000 else word
+
+def bspFloat(value):
+    # Same rounding as ftoa() of app/print.h : 4 decimals, half up, clamped to 32 bits
+    if value != value:
+        return 'nan'
+    negative = value < 0
+    value = min(-value if negative else value, 4294967295.0)
+    ipart = int(value)
+    fpart = int((value - ipart) * 10000.0 + 0.5)
+    if fpart >= 10000:
+        fpart -= 10000
+        ipart = (ipart + 1) & 0xFFFFFFFF
+    return '%s%d.%04d' % ('-' if negative else '', ipart, fpart)
+
+def format(elf, text, args):
+    args = list(args)
+    def convert(match):
+        flags, width, precision, conversion = match.groups()
+        if conversion == '%':
+            return '%'
+        if not args:
+            return '<missing>'
+        word = args.pop(0)
+        spec = '%' + flags + width + ('.' + precision if precision is not None else '')
+        plain = spec == '%' # No flags, width nor precision, print like bsp_printf
+        if conversion in 'di':
+            return (spec + 'd') % signed(word)
+        if conversion == 'u':
+            return (spec + 'd') % word
+        if conversion in 'xX' and plain:
+            return ('%08' + conversion) % word
+        if conversion in 'xXo':
+            return (spec + conversion) % word
+        if conversion == 'p':
+            return '0x%08x' % word
+        if conversion == 'c':
+            return (spec + 'c') % chr(word & 0xFF)
+        if conversion == 's':
+            return (spec + 's') % elf.string(word)
+        value = struct.unpack('<f', struct.pack('<I', word))[0]
+        if conversion == 'f' and plain:
+            return bspFloat(value)
+        return (spec + conversion) % value
+    return SPECIFIER.sub(convert, text)
+
+def leb128(stream):
+    value = 0
+    shift = 0
+    raw = []
+    while True:
+        byte = next(stream)
+        raw.append(byte)
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value & 0xFFFFFFFF, raw
+        shift += 7
+
+def frame(elf, stream):
+    checksum = 0
+    token, raw = leb128(stream)
+    checksum += sum(raw)
+    argc = next(stream)
+    checksum += argc
+    args = []
+    for i in range(argc):
+        arg, raw = leb128(stream)
+        checksum += sum(raw)
+        args.append(arg)
+    if next(stream) != checksum & 0xFF:
+        return '<bad token frame>'
+    text = elf.token(token)
+    if text is None:
+        return '<unknown token %d>' % token
+    return format(elf, text, args)
+
+def decode(elf, stream, out):
+    for byte in stream:
+        if byte == TOKEN_SYNC:
+            out.write(frame(elf, stream))
+        else:
+            out.write(chr(byte))
+        out.flush()
+
+def serialBytes(port):
+    while True:
+        data = port.read(256)
+        for byte in data:
+            yield byte
+
+def fileBytes(path):
+    with open(path, 'rb') as f:
+        for byte in f.read():
+            yield byte
+
+def parse_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-e',
+                        '--elf',
+                        required=True,
+                        help='application ELF, for eg tokenPrintDemo.elf')
+    parser.add_argument('-p',
+                        '--port',
+                        help='serial port, for eg /dev/ttyUSB1 or COM5')
+    parser.add_argument('-b',
+                        '--baudrate',
+                        default=115200,
+                        type=int,
+                        help='baudrate of the serial port')
+    parser.add_argument('-i',
+                        '--input',
+                        help='raw capture file to decode instead of a serial port')
+    return parser.parse_args()
+
+if __name__ == '__main__':
+    args = parse_args()
+    elf = Elf(args.elf)
+    if args.input:
+        stream = fileBytes(args.input)
+    elif args.port:
+        try:
+            import serial
+        except ImportError:
+            print('pyserial is required, install it with "pip install pyserial".')
+            quit()
+        stream = serialBytes(serial.Serial(args.port, args.baudrate, timeout=0.05))
+    else:
+        print('either a serial port or an input file is required')
+        sys.exit(1)
+    try:
+        decode(elf, stream, sys.stdout)
+    except (StopIteration, RuntimeError, KeyboardInterrupt):
+        pass
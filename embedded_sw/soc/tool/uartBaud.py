@@ -0,0 +1,115 @@
+import argparse
+import sys
+import time
+
+try:
+    import serial
+except ImportError:
+    print('pyserial is required, install it with "pip install pyserial".')
+    quit()
+
+# Host side of the UART baudrate negotiation, see driver/uartBaud.h for the protocol.
+# The target runs uartBaudDemo, which proposes its baudrates every time it is back at the default rate.
+
+def readLine(port, timeout):
+    deadline = time.time() + timeout
+    line = b''
+    while time.time() < deadline:
+        c = port.read(1)
+        if not c:
+            continue
+        if c == b'\n':
+            return line.rstrip(b'\r').decode('ascii', 'replace')
+        line += c
+    return None
+
+def waitPrefix(port, prefix, timeout):
+    deadline = time.time() + timeout
+    while time.time() < deadline:
+        line = readLine(port, deadline - time.time())
+        if line is not None and line.startswith(prefix):
+            return line
+    return None
+
+def readBytes(port, size, timeout):
+    # port.read() gives up after the port timeout, keep reading until size bytes or the deadline
+    deadline = time.time() + timeout
+    data = b''
+    while len(data) < size and time.time() < deadline:
+        data += port.read(size - len(data))
+    return data
+
+def testPattern(size):
+    return bytes((0x30 + (i & 0x3F)) for i in range(size))
+
+def runRate(port, rate, default, timeout):
+    port.baudrate = default
+    proposal = waitPrefix(port, '#BAUD?', timeout)
+    if proposal is None:
+        return 'no proposal from the target'
+    offered = [int(r) for r in proposal[6:].split(',') if r]
+    if rate not in offered:
+        port.write(b'#BAUD!0\n')
+        return 'not proposed by the target (divider error too large), offered %s' % offered
+
+    port.write(b'#BAUD!%d\n' % rate)
+    port.flush()
+    port.baudrate = rate
+    port.reset_input_buffer()
+    if waitPrefix(port, '#SYNC', timeout) is None:
+        return 'no sync at the new rate, target fell back to %d' % default
+    port.write(b'#ACK\n')
+
+    test = waitPrefix(port, '#TEST', timeout)
+    if test is None:
+        return 'no test header'
+    size = int(test.split()[1])
+    start = time.time()
+    data = readBytes(port, size, timeout + size * 10.0 / rate)
+    elapsed = time.time() - start
+    expected = testPattern(size)
+    rxErrors = sum(1 for a, b in zip(data, expected) if a != b) + size - len(data)
+
+    port.write(expected)
+    port.flush()
+    result = waitPrefix(port, '#RESULT', timeout + size * 10.0 / rate)
+    port.baudrate = default
+    if result is None:
+        return 'no result from the target'
+    fields = result.split()
+    return 'divider %s, host rx %d bytes/s %d errors, target rx %s errors, target tx %s bytes/s' % (
+        fields[2], len(data) / elapsed if elapsed else 0, rxErrors, fields[3], fields[5])
+
+def parse_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-p',
+                        '--port',
+                        required=True,
+                        help='serial port, for eg /dev/ttyUSB1 or COM5')
+    parser.add_argument('-r',
+                        '--rates',
+                        default='921600,1000000,2000000,2500000,3000000',
+                        help='comma separated baudrates to validate')
+    parser.add_argument('-d',
+                        '--default',
+                        default=115200,
+                        type=int,
+                        help='default baudrate of the target')
+    parser.add_argument('-t',
+                        '--timeout',
+                        default=5.0,
+                        type=float,
+                        help='timeout of each protocol step in seconds')
+    return parser.parse_args()
+
+if __name__ == '__main__':
+    args = parse_args()
+    port = serial.Serial(args.port, args.default, timeout=0.05)
+    status = 0
+    for rate in [int(r) for r in args.rates.split(',')]:
+        report = runRate(port, rate, args.default, args.timeout)
+        print('%8d baud : %s' % (rate, report))
+        if not report.startswith('divider'):
+            status = 1
+    port.close()
+    sys.exit(status)
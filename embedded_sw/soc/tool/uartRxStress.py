@@ -0,0 +1,105 @@
+import argparse
+import random
+import sys
+import time
+
+try:
+    import serial
+except ImportError:
+    print('pyserial is required, install it with "pip install pyserial".')
+    quit()
+
+from uartBaud import waitPrefix
+
+# Host side of uartRxStressDemo, stress test of the interrupt driven receiver (driver/uartRx.h).
+# The baudrate is negotiated as in uartBaud.py, then numbered lines are streamed back to back
+# and the target reports how many were received, corrupted or dropped.
+
+PAYLOAD = b'abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789'
+
+def stressLines(count, maxPayload, seed):
+    generator = random.Random(seed)
+    data = bytearray()
+    for sequence in range(count):
+        payload = bytes(generator.choice(PAYLOAD) for i in range(generator.randint(1, maxPayload)))
+        data += b'%d %s %d\n' % (sequence, payload, sum(payload) & 0xFF)
+    return bytes(data)
+
+def runStress(port, rate, default, lines, maxPayload, timeout):
+    port.baudrate = default
+    proposal = waitPrefix(port, '#BAUD?', timeout)
+    if proposal is None:
+        return 'no proposal from the target'
+    offered = [int(r) for r in proposal[6:].split(',') if r]
+    if rate not in offered:
+        port.write(b'#BAUD!0\n')
+        return 'not proposed by the target (divider error too large), offered %s' % offered
+
+    port.write(b'#BAUD!%d\n' % rate)
+    port.flush()
+    port.baudrate = rate
+    port.reset_input_buffer()
+    if waitPrefix(port, '#SYNC', timeout) is None:
+        return 'no sync at the new rate, target fell back to %d' % default
+    port.write(b'#ACK\n')
+    if waitPrefix(port, '#STRESS', timeout) is None:
+        return 'no stress header'
+
+    data = stressLines(lines, maxPayload, rate)
+    start = time.time()
+    port.write(data)
+    port.write(b'END\n')
+    port.flush()
+    elapsed = time.time() - start
+    result = waitPrefix(port, '#RESULT', timeout + len(data) * 10.0 / rate)
+    port.baudrate = default
+    if result is None:
+        return 'no result from the target'
+    received, errors, overflows, maxBurst, interrupts, ms = [int(f) for f in result.split()[1:7]]
+    status = 'PASS' if received == lines and errors == 0 and overflows == 0 else 'FAIL'
+    return '%s %d/%d lines, %d errors, %d bytes dropped, %d bytes max per interrupt, %d interrupts, %d bytes in %d ms (host %d bytes/s)' % (
+        status, received, lines, errors, overflows, maxBurst, interrupts, len(data), ms, len(data) / elapsed if elapsed else 0)
+
+def parse_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('-p',
+                        '--port',
+                        required=True,
+                        help='serial port, for eg /dev/ttyUSB1 or COM5')
+    parser.add_argument('-r',
+                        '--rates',
+                        default='1000000',
+                        help='comma separated baudrates to stress, among the ones the target offers')
+    parser.add_argument('-d',
+                        '--default',
+                        default=115200,
+                        type=int,
+                        help='default baudrate of the target')
+    parser.add_argument('-n',
+                        '--lines',
+                        default=20000,
+                        type=int,
+                        help='number of lines sent for each baudrate')
+    parser.add_argument('-l',
+                        '--length',
+                        default=48,
+                        type=int,
+                        help='maximum payload length of a line')
+    parser.add_argument('-t',
+                        '--timeout',
+                        default=5.0,
+                        type=float,
+                        help='timeout of each protocol step in seconds')
+    return parser.parse_args()
+
+if __name__ == '__main__':
+    args = parse_args()
+    port = serial.Serial(args.port, args.default, timeout=0.05)
+    status = 0
+    for rate in [int(r) for r in args.rates.split(',')]:
+        report = runStress(port, rate, args.default, args.lines, args.length, args.timeout)
+        print('%8d baud : %s' % (rate, report))
+        if not report.startswith('PASS'):
+            status = 1
+    port.close()
+    sys.exit(status)